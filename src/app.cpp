@@ -59,12 +59,15 @@ namespace Fantasy {
         if(SDL_GL_SetSwapInterval(1) != 0) SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "VSync disabled.");
 
         exiting = false;
+        frameAllocs = 0;
         instance = this;
 
+        arena = new FrameArena();
+        jobs = new Jobs(config.threads);
         input = new Input();
         listeners = new std::vector<AppListener *>();
         listeners->push_back(control = new GameController());
-        listeners->push_back(renderer = new Renderer());
+        listeners->push_back(renderer = new Renderer(config.instanced, config.compact, config.bloom));
 
         setFullscreen(config.fullscreen);
         Events::fire<AppLoadEvent>(AppLoadEvent());
@@ -74,6 +77,8 @@ namespace Fantasy {
         for(auto listener : *listeners) delete listener;
         delete listeners;
         delete input;
+        delete jobs;
+        delete arena;
 
         SDL_DestroyWindow(window);
         SDL_GL_DeleteContext(context);
@@ -85,6 +90,7 @@ namespace Fantasy {
     bool App::run() {
         SDL_Event e;
         while(!exiting) {
+            size_t allocs = Memory::allocations();
             while(SDL_PollEvent(&e) != 0) {
                 switch(e.type) {
                     case SDL_QUIT:
@@ -95,14 +101,29 @@ namespace Fantasy {
                 }
             }
 
+            // The next tick simulates on the job threads while this one submits the previous tick's snapshot.
             try {
-                for(auto it : *listeners) it->update();
+                JobGroup ticking;
+                jobs->submit([this]() { control->update(); }, ticking);
+
+                try {
+                    renderer->update();
+                } catch(...) {
+                    jobs->wait(ticking);
+                    throw;
+                }
+
+                jobs->wait(ticking);
+                control->snapshots->swap();
             } catch(std::exception &e) {
                 SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s", e.what());
                 return false;
             }
 
             SDL_GL_SwapWindow(window);
+            arena->reset();
+
+            frameAllocs = Memory::allocations() - allocs;
         }
 
         return true;
@@ -156,4 +177,5 @@ namespace Fantasy {
     }
 
     float App::getAspect() { return (float)getWidth() / (float)getHeight(); }
+    size_t App::getFrameAllocs() { return frameAllocs; }
 }
@@ -11,11 +11,17 @@
 #include "core/renderer.h"
 #include "core/input.h"
 #include "core/game_controller.h"
+#include "util/memory.h"
+#include "util/jobs.h"
 
 namespace Fantasy {
     struct AppConfig {
         int width = 800;
         int height = 600;
+        int threads = -1;
+        bool instanced = false;
+        bool compact = false;
+        Bloom::Quality bloom = Bloom::MEDIUM;
         bool visible;
         bool fullscreen;
         bool resizable;
@@ -33,11 +39,14 @@ namespace Fantasy {
         Input *input;
         GameController *control;
         Renderer *renderer;
+        FrameArena *arena;
+        Jobs *jobs;
 
         private:
         bool exiting;
         bool fullscreen;
         int lastWidth, lastHeight;
+        size_t frameAllocs;
 
         public:
         App(int, char *[], AppConfig);
@@ -55,14 +64,19 @@ namespace Fantasy {
         int getMouseX();
         int getMouseY();
         float getAspect();
+        size_t getFrameAllocs();
 
         static inline GameController &icontrol() { return *instance->control; }
         static inline Contents &icontent() { return *instance->control->content; }
         static inline entt::registry &iregistry() { return *instance->control->regist; }
         static inline b2World &iworld() { return *instance->control->world; }
+        static inline Projectiles &iprojectiles() { return *instance->control->projectiles; }
         static inline Renderer &irenderer() { return *instance->renderer; }
         static inline TexAtlas &iatlas() { return *instance->renderer->atlas; }
-        static inline SpriteBatch &ibatch() { return *instance->renderer->batch; }
+        static inline FrameUniforms &iuniforms() { return *instance->renderer->uniforms; }
+        static inline SpriteBatch &ibatch() { return Renderer::recording != nullptr ? *Renderer::recording : *instance->renderer->batch; }
+        static inline FrameArena &iarena() { return *instance->arena; }
+        static inline Jobs &ijobs() { return *instance->jobs; }
     };
 }
 
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "graphics/sprite_kernel.h"
+#include "util/mathf.h"
+#include "util/sort.h"
+
+using namespace Fantasy;
+
+using Clock = std::chrono::steady_clock;
+
+static double seconds(Clock::time_point since) {
+    return std::chrono::duration<double>(Clock::now() - since).count();
+}
+
+// What SpriteBatch::draw did per sprite before it took instances: a rotation matrix, four matrix products, then the
+// vertices staged in a scratch array and copied over.
+static void writeMatrix(float *out, const SpriteInstance &sprite, float rotation) {
+    const TexRegion &region = *sprite.region;
+    glm::mat4 trns = glm::rotate(glm::identity<glm::mat4>(), rotation, glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::vec2 pos[4] = {
+        trns * glm::vec4(sprite.originX, sprite.originY, 0.0f, 1.0f),
+        trns * glm::vec4(sprite.originX + sprite.width, sprite.originY, 0.0f, 1.0f),
+        trns * glm::vec4(sprite.originX + sprite.width, sprite.originY + sprite.height, 0.0f, 1.0f),
+        trns * glm::vec4(sprite.originX, sprite.originY + sprite.height, 0.0f, 1.0f)
+    };
+
+    float us[4] = {region.u, region.u2, region.u2, region.u};
+    float vs[4] = {region.v, region.v, region.v2, region.v2};
+    float tmp[4 * 7];
+    for(int i = 0; i < 4; i++) {
+        float *vert = tmp + i * 7;
+        vert[0] = pos[i].x + sprite.x;
+        vert[1] = pos[i].y + sprite.y;
+        writeBits(vert + 2, sprite.color);
+        writeBits(vert + 3, sprite.tint);
+        vert[4] = us[i];
+        vert[5] = vs[i];
+        vert[6] = region.layer;
+    }
+
+    std::memcpy(out, tmp, sizeof(tmp));
+}
+
+static void benchSprites(bool rotated) {
+    const size_t count = 8192, rounds = 1000;
+
+    TexRegion region;
+    std::mt19937 rand(7);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f), angle(0.0f, 6.2831853f);
+
+    std::vector<SpriteInstance> sprites(count);
+    std::vector<float> rotations(count);
+    for(size_t i = 0; i < count; i++) {
+        float rotation = rotated ? angle(rand) : 0.0f;
+        rotations[i] = rotation;
+        sprites[i] = {&region, coord(rand), coord(rand), -0.5f, -0.5f, 1.0f, 1.0f, sinf(rotation), cosf(rotation), 0xffffffffu, 0u};
+    }
+
+    std::vector<float> out(count * 4 * 7);
+    float sum = 0.0f;
+
+    Clock::time_point start = Clock::now();
+    for(size_t r = 0; r < rounds; r++) {
+        for(size_t i = 0; i < count; i++) writeMatrix(out.data() + i * 4 * 7, sprites[i], rotations[i]);
+        sum += out[(r % count) * 4 * 7];
+    }
+    double matrix = seconds(start);
+
+    start = Clock::now();
+    for(size_t r = 0; r < rounds; r++) {
+        writeSprites(out.data(), sprites.data(), count);
+        sum += out[(r % count) * 4 * 7];
+    }
+    double kernel = seconds(start);
+
+    double total = (double)count * rounds / 1e6;
+    std::printf(
+        "sprites, %s: matrix %.1fM/s, kernel %.1fM/s (%.2fx) [%g]\n",
+        rotated ? "rotated" : "unrotated", total / matrix, total / kernel, matrix / kernel, sum
+    );
+}
+
+struct SortItem {
+    float z;
+    uint32_t entity, page, drawer;
+};
+
+// Visible items over 8 z layers, 4 atlas pages and 12 drawers, sorted the way drawing used to and by packed keys.
+static void benchSort(size_t count) {
+    const size_t rounds = 50;
+
+    std::mt19937 rand(count);
+    std::vector<SortItem> items(count);
+    for(size_t i = 0; i < count; i++) items[i] = {(float)(rand() % 8) * 0.5f, (uint32_t)i, (uint32_t)(rand() % 4), (uint32_t)(rand() % 12)};
+
+    std::vector<const SortItem *> pointers(count);
+    std::vector<SortKey> keys(count), scratch(count);
+    uint64_t sum = 0;
+
+    double pointer = 0.0;
+    for(size_t r = 0; r < rounds; r++) {
+        for(size_t i = 0; i < count; i++) pointers[i] = &items[i];
+
+        Clock::time_point start = Clock::now();
+        std::sort(pointers.begin(), pointers.end(), [](const SortItem *a, const SortItem *b) {
+            if(Mathf::near(a->z, b->z)) {
+                return a->entity < b->entity;
+            } else {
+                return a->z < b->z;
+            }
+        });
+        pointer += seconds(start);
+        sum += pointers[r % count]->entity;
+    }
+
+    // Building the keys is timed too, since the renderer does it for every visible item each frame.
+    double radix = 0.0;
+    for(size_t r = 0; r < rounds; r++) {
+        Clock::time_point start = Clock::now();
+        for(size_t i = 0; i < count; i++) {
+            const SortItem &item = items[i];
+            uint64_t z = Sort::orderedBits(item.z) >> 8;
+            keys[i] = {z << 40 | (uint64_t)item.page << 32 | (uint64_t)item.drawer << 20 | (item.entity & 0xfffff), (uint32_t)i};
+        }
+
+        Sort::radix(keys.data(), scratch.data(), count);
+        radix += seconds(start);
+        sum += keys[r % count].value;
+    }
+
+    std::printf(
+        "sort, %zu visible: pointers %.0fus, keys and radix %.0fus (%.2fx) [%llu]\n",
+        count, pointer / rounds * 1e6, radix / rounds * 1e6, pointer / radix, (unsigned long long)sum
+    );
+}
+
+int main(int argc, char **argv) {
+#ifdef FANTASY_SSE
+    std::printf("Quad kernel built with SSE.\n");
+#else
+    std::printf("Quad kernel built without SSE.\n");
+#endif
+
+    benchSprites(false);
+    benchSprites(true);
+    benchSort(10000);
+    benchSort(100000);
+    return 0;
+}
@@ -10,6 +10,8 @@
 namespace Fantasy {
     Contents::Contents() {
         contents = new std::vector<std::unordered_map<std::string, Content *> *>((int)CType::ALL);
+        indexed = new std::vector<std::vector<Content *> *>((int)CType::ALL);
+        sounds = new std::vector<Mix_Chunk *>(1, nullptr);
 
         sfxShootSmall = loadSound("shoot-small");
         sfxShootMed = loadSound("shoot-medium");
@@ -19,31 +21,21 @@ namespace Fantasy {
         sfxExplodeMed = loadSound("explode-medium");
         sfxExplodeBig = loadSound("explode-big");
 
-        genericRegion = create<DrawType>("drawer-generic-region", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-
-            DrawComp &comp = registry.get<DrawComp>(e);
-            if(!comp.region) return;
-            
-            b2Body *body = registry.get<RigidComp>(e).body;
-            b2Vec2 pos = body->GetPosition();
-            App::ibatch().draw(*comp.region, pos.x, pos.y, comp.width, comp.height, body->GetAngle() - glm::radians(90.0f));
+        genericRegion = create<DrawType>("drawer-generic-region", [](const RenderItem &item) {
+            if(!item.region) return;
+            App::ibatch().draw(App::iatlas().get(item.region), item.pos.x, item.pos.y, item.width, item.height, item.rotation - glm::radians(90.0f));
         });
 
-        drawJumper = create<DrawType>("drawer-jumper", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
+        drawJumper = create<DrawType>("drawer-jumper", [](const RenderItem &item) {
             TexAtlas &atlas = App::iatlas();
             SpriteBatch &batch = App::ibatch();
+            const b2Vec2 &pos = item.pos;
 
-            DrawComp &comp = registry.get<DrawComp>(e);
-            JumpComp &jump = registry.get<JumpComp>(e);
-            b2Body *body = registry.get<RigidComp>(e).body;
-            b2Vec2 pos = body->GetPosition();
-
-            if(jump.isHolding()) {
-                float frac = fminf((Time::time() - jump.getTime()) / jump.timeout, 1.0f);
+            // Progress is the charge fraction while holding a jump, and negative otherwise.
+            if(item.progress >= 0.0f) {
+                float frac = item.progress;
 
-                Mathf::randVecs(jump.getTime() * 100.0f, 7, 3.0f, powf(1.0f - frac, 2.0f), [&](float x, float y) {
+                Mathf::randVecs(item.seed * 100.0f, 7, 3.0f, powf(1.0f - frac, 2.0f), [&](float x, float y) {
                     float size = frac * 0.75f;
 
                     batch.col(Color(Color::blue).lerp(Color::white, frac));
@@ -65,11 +57,11 @@ namespace Fantasy {
 
                 float size = 1.4f + sinf(Time::time() * 20.0f) * 0.2f;
                 batch.col(Color(1.0f, 1.0f, 1.0f, powf(frac, 3.0f) * 0.5f));
-                batch.draw(atlas.get("jumper"), pos.x, pos.y, size, size, body->GetAngle() - glm::radians(90.0f));
+                batch.draw(atlas.get("jumper"), pos.x, pos.y, size, size, item.rotation - glm::radians(90.0f));
                 batch.col(Color::white);
             }
 
-            batch.draw(atlas.get("jumper"), pos.x, pos.y, 1.0f, 1.0f, body->GetAngle() - glm::radians(90.0f));
+            batch.draw(atlas.get("jumper"), pos.x, pos.y, 1.0f, 1.0f, item.rotation - glm::radians(90.0f));
         });
 
         jumper = create<EntityType>("ent-jumper", [this](entt::entity e) {
@@ -90,16 +82,18 @@ namespace Fantasy {
             b2Body *body = App::iworld().CreateBody(&bodyDef);
             body->CreateFixture(&fixt);
 
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.deathFx = destructMed->name;
+            registry.emplace<RigidComp>(e, e, body);
+
+            FxComp &comp = registry.emplace<FxComp>(e, e);
+            comp.deathFx = destructMed->id;
             comp.deathSfx = sfxExplodeMed;
 
-            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletSmall->name, 0.24f);
-            shoot.shootFx = smokeSmall->name;
+            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletSmall, 0.24f);
+            shoot.shootFx = smokeSmall->id;
             shoot.shootSfx = sfxShootSmall;
 
-            registry.emplace<DrawComp>(e, e, drawJumper->name, 1.0f, 1.0f, 2.0f);
-            registry.emplace<JumpComp>(e, e, 100.0f, 0.5f).effect = jumped->name;
+            registry.emplace<DrawComp>(e, e, drawJumper->id, 1.0f, 1.0f, 2.0f);
+            registry.emplace<JumpComp>(e, e, 100.0f, 0.5f).effect = jumped->id;
             registry.emplace<HealthComp>(e, e, 150.0f, 5.0f, 0.04f);
             registry.emplace<TeamComp>(e, e, Team::AZURE, 10.0f);
         });
@@ -125,41 +119,47 @@ namespace Fantasy {
             b2Body *body = App::iworld().CreateBody(&bodyDef);
             body->CreateFixture(&fixt);
             
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.rotateSpeed = glm::radians(Mathf::random(1.0f, 2.5f) * (Mathf::random() >= 0.5f ? 1.0f : -1.0f));
-            comp.deathFx = destructBig->name;
+            registry.emplace<RigidComp>(e, e, body);
+
+            FxComp &comp = registry.emplace<FxComp>(e, e);
+            comp.deathFx = destructBig->id;
             comp.deathSfx = sfxExplodeMed;
 
-            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletMed->name, 1.2f, 5.0f, 10.0f);
-            shoot.shootFx = smokeBig->name;
+            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletMed, 1.2f, 5.0f, 10.0f);
+            shoot.shootFx = smokeBig->id;
             shoot.shootSfx = sfxShootMed;
 
-            registry.emplace<DrawComp>(e, e, genericRegion->name, 2.0f, 2.0f, 1.0f).region = App::iatlas().get("spike");
+            DrawComp &draw = registry.emplace<DrawComp>(e, e, genericRegion->id, 2.0f, 2.0f, 1.0f);
+            draw.region = App::iatlas().find("spike");
+            draw.spin = glm::radians(Mathf::random(60.0f, 150.0f) * (Mathf::random() >= 0.5f ? 1.0f : -1.0f));
             registry.emplace<HealthComp>(e, e, 100.0f, 10.0f);
             registry.emplace<TeamComp>(e, e, Team::KAYDE, 15.0f);
         });
 
-        drawLeak = create<DrawType>("drawer-ent-leak", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
+        drawLeak = create<DrawType>("drawer-ent-leak", [this](const RenderItem &item) {
             TexAtlas &atlas = App::iatlas();
             SpriteBatch &batch = App::ibatch();
 
-            b2Vec2 pos = registry.get<RigidComp>(e).body->GetPosition();
+            const b2Vec2 &pos = item.pos;
+            entt::entity e = item.entity;
+            float loop = item.progress / drawLeak->period * glm::two_pi<float>();
 
+            // Everything turns a whole number of times per loop: the layers close to 0.25, 0.33, 0.5 and 1 half turns a
+            // second, the rays from 0.2 turns a second at the core down to none at the tips.
             const TexRegion regions[] = {atlas.get("leak-4"), atlas.get("leak-3"), atlas.get("leak-2"), atlas.get("leak-1")};
-            float speeds[] = {0.25f, 0.33f, 0.5f, 1.0f};
+            float turns[] = {1.0f, 1.0f, 2.0f, 4.0f};
             float direction = (unsigned int)e % 2 == 0 ? 1.0f : -1.0f;
             for(int i = 0; i < 4; i++) {
                 const TexRegion &region = regions[i];
 
-                float rot = fmodf(speeds[i] * direction * Time::time() * glm::pi<float>() + Mathf::srandom((unsigned int)e + i, glm::pi<float>()), glm::two_pi<float>());
+                float rot = fmodf(turns[i] * direction * loop + Mathf::srandom((unsigned int)e + i, glm::pi<float>()), glm::two_pi<float>());
                 batch.draw(region, pos.x, pos.y, region.width / 8.0f, region.height / 8.0f, rot);
             }
 
             Mathf::randVecs((unsigned int)e, 64,
                 4.0f, 20.0f, 1.0f,
-                0.2f * direction * Time::time() * glm::two_pi<float>(),
-                [](float len) { return 0.08f + (1.0f - (len - 4.0f) / 16.0f) * 0.92f; },
+                direction * loop,
+                [this](float len) { return roundf(0.2f * drawLeak->period * (0.08f + (1.0f - (len - 4.0f) / 16.0f) * 0.92f)); },
                 [&](float x, float y) {
                     float dst = glm::length(glm::vec2(x, y)) / 20.0f;
 
@@ -170,6 +170,11 @@ namespace Fantasy {
             );
         });
 
+        // The rays reach out to 24 units around the core, which makes a frame 384 pixels square at the atlas' resolution.
+        // Even a frame a second for both directions would take 9 MB and couldn't follow the rays turning, so it's live.
+        drawLeak->period = 8.0f;
+        drawLeak->extent = 48.0f;
+
         leak = create<EntityType>("ent-leak", [this](entt::entity e) {
             entt::registry &registry = App::iregistry();
 
@@ -186,105 +191,31 @@ namespace Fantasy {
             fixt.density = 1000.0f;
             fixt.friction = 0.8f;
 
-            b2CircleShape clipSize;
-            clipSize.m_radius = 24.0f;
-
-            b2FixtureDef clip;
-            clip.shape = &clipSize;
-            clip.isSensor = true;
-
             b2Body *body = App::iworld().CreateBody(&bodyDef);
             body->CreateFixture(&fixt);
-            body->CreateFixture(&clip);
 
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.deathFx = leaked->name;
+            registry.emplace<RigidComp>(e, e, body);
+
+            FxComp &comp = registry.emplace<FxComp>(e, e);
+            comp.deathFx = leaked->id;
             comp.deathSfx = sfxExplodeBig;
 
-            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletLeak->name, 0.84f, 24.0f, 48.0f);
-            shoot.shootFx = laserDefuse->name;
+            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, bulletLeak, 0.84f, 24.0f, 48.0f);
+            shoot.shootFx = laserDefuse->id;
             shoot.shootSfx = sfxShootSummon;
 
             registry.emplace<HealthComp>(e, e, 480.0f, 150.0f);
             registry.emplace<TeamComp>(e, e, Team::KAYDE, 30.0f);
-            registry.emplace<DrawComp>(e, e, drawLeak->name, 1.0f, 1.0f, 2.5f);
+            registry.emplace<DrawComp>(e, e, drawLeak->id, 1.0f, 1.0f, 2.5f).clip = drawLeak->extent;
             registry.emplace<IdentifierComp>(e, e, "leak");
         });
 
-        bulletSmall = create<EntityType>("ent-bullet-small", [this](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-
-            b2BodyDef bodyDef;
-            bodyDef.type = b2_dynamicBody;
-            bodyDef.position.SetZero();
-            bodyDef.bullet = true;
-            bodyDef.gravityScale = 0.01f;
-
-            b2CircleShape shape;
-            shape.m_radius = 0.25f;
-
-            b2FixtureDef fixt;
-            fixt.density = 1.0f;
-            fixt.shape = &shape;
-            fixt.friction = 0.05f;
-
-            b2Body *body = App::iworld().CreateBody(&bodyDef);
-            body->CreateFixture(&fixt);
-
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.deathFx = destructSmall->name;
-            comp.deathSfx = sfxExplodeSmall;
-
-            HealthComp &health = registry.emplace<HealthComp>(e, e, 5.0f, 10.0f);
-            health.selfDamage = true;
-            health.showBar = false;
-
-            registry.emplace<DrawComp>(e, e, genericRegion->name, 0.5f, 0.5f, 3.0f).region = App::iatlas().get("bullet-small");
-            registry.emplace<TeamComp>(e, e, 1.0f);
-            registry.emplace<TemporalComp>(e, e, TemporalComp::RANGE);
-        });
-
-        bulletMed = create<EntityType>("ent-bullet-medium", [this](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-
-            b2BodyDef bodyDef;
-            bodyDef.type = b2_dynamicBody;
-            bodyDef.position.SetZero();
-            bodyDef.bullet = true;
-            bodyDef.gravityScale = 0.04f;
-
-            b2CircleShape shape;
-            shape.m_radius = 0.5f;
-
-            b2FixtureDef fixt;
-            fixt.density = 1.0f;
-            fixt.shape = &shape;
-            fixt.friction = 0.05f;
-
-            b2Body *body = App::iworld().CreateBody(&bodyDef);
-            body->CreateFixture(&fixt);
-
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.rotateSpeed = glm::radians(Mathf::random() > 0.5f ? 10.0f : -10.0f);
-            comp.deathFx = destructSmall->name;
-            comp.deathSfx = sfxExplodeSmall;
-
-            HealthComp &health = registry.emplace<HealthComp>(e, e, 10.0f, 20.0f);
-            health.selfDamage = true;
-            health.showBar = false;
-
-            registry.emplace<DrawComp>(e, e, genericRegion->name, 0.75f, 0.75f, 3.0f).region = App::iatlas().get("bullet-medium");
-            registry.emplace<TeamComp>(e, e, 2.0f);
-            registry.emplace<TemporalComp>(e, e, TemporalComp::RANGE);
-        });
-
         bulletLeak = create<EntityType>("ent-bullet-leak", [this](entt::entity e) {
             entt::registry &registry = App::iregistry();
 
             b2BodyDef bodyDef;
             bodyDef.type = b2_dynamicBody;
             bodyDef.position.SetZero();
-            bodyDef.bullet = true;
             bodyDef.gravityScale = 0.0f;
 
             b2CircleShape shape;
@@ -298,288 +229,178 @@ namespace Fantasy {
             b2Body *body = App::iworld().CreateBody(&bodyDef);
             body->CreateFixture(&fixt);
 
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.deathFx = destructBig->name;
+            registry.emplace<RigidComp>(e, e, body);
+
+            FxComp &comp = registry.emplace<FxComp>(e, e);
+            comp.deathFx = destructBig->id;
             comp.deathSfx = sfxExplodeMed;
 
-            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, laser->name, 0.5f);
-            shoot.shootFx = smokeBig->name;
+            ShooterComp &shoot = registry.emplace<ShooterComp>(e, e, laser, 0.5f);
+            shoot.shootFx = smokeBig->id;
             shoot.shootSfx = sfxShootEnergy;
 
-            registry.emplace<DrawComp>(e, e, genericRegion->name, 1.25f, 1.25f, 3.5f).region = App::iatlas().get("bullet-leak");
+            registry.emplace<DrawComp>(e, e, genericRegion->id, 1.25f, 1.25f, 3.5f).region = App::iatlas().find("bullet-leak");
             registry.emplace<HealthComp>(e, e, 100.0f, 100.0f);
             registry.emplace<TeamComp>(e, e, 20.0f);
             registry.emplace<TemporalComp>(e, e, TemporalComp::RANGE);
         });
 
-        laser = create<EntityType>("ent-laser", [this](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-
-            b2BodyDef bodyDef;
-            bodyDef.type = b2_dynamicBody;
-            bodyDef.position.SetZero();
-            bodyDef.bullet = true;
-            bodyDef.gravityScale = 0.0f;
-
-            b2PolygonShape shape;
-            shape.SetAsBox(0.125f, 1.5f);
-
-            b2FixtureDef fixt;
-            fixt.density = 0.2f;
-            fixt.shape = &shape;
-
-            b2Body *body = App::iworld().CreateBody(&bodyDef);
-            body->CreateFixture(&fixt);
-            
-            RigidComp &comp = registry.emplace<RigidComp>(e, e, body);
-            comp.deathFx = laserDefuse->name;
-            comp.deathSfx = sfxExplodeSmall;
-
-            HealthComp &health = registry.emplace<HealthComp>(e, e, 5.0f, 10.0f);
-            health.selfDamage = true;
-            health.showBar = false;
-
-            registry.emplace<DrawComp>(e, e, genericRegion->name, 0.25f, 2.0f, 3.0f).region = App::iatlas().get("laser");
-            registry.emplace<TeamComp>(e, e, 10.0f);
-            registry.emplace<TemporalComp>(e, e, TemporalComp::RANGE);
+        // Effect progress is linear over the lifetime; each emitter eases it into its own spread.
+        Color clearBlue = Color(Color::blue.r, Color::blue.g, Color::blue.b, 0.0f);
+        Color clearPurple = Color(Color::purple.r, Color::purple.g, Color::purple.b, 0.0f);
+        EffectCurve fade = EffectCurve::linear().reversed();
+
+        jumped = create<EffectType>("fx-jumped", std::vector<EffectEmitter>{
+            EffectEmitter(12, 2.0f, EffectCurve::out(2.5f))
+                .sized(fade, 0.0f, 1.0f)
+                .colored(EffectCurve::linear(), Color::lpurple, Color::gray),
+            EffectEmitter(0, 0.0f, EffectCurve::out(2.5f))
+                .sized(fade, 0.0f, 2.5f)
+                .colored(fade, Color::white, clearBlue)
+                .rotated(glm::radians(45.0f)),
+            EffectEmitter(0, 0.0f, EffectCurve::out(2.5f))
+                .sized(EffectCurve::linear(), 0.0f, 2.5f)
+                .colored(EffectCurve::linear(), Color::blue, Color())
         });
-
-        jumped = create<EffectType>("fx-jumped", create<DrawType>("drawer-fx-jumped", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-            SpriteBatch &batch = App::ibatch();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = 1.0f - powf(1.0f - life.timef(), 2.5f);
-
-            App::ibatch().col(Color(Color::lpurple).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 12, 2.0f, l, [&](float x, float y) {
-                float s = (1.0f - l);
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, s, s);
-            });
-
-            float size = (1.0f - l) * 2.5f;
-            batch.col(Color(Color::white).lerp(Color(Color::blue.r, Color::blue.g, Color::blue.b, 0.0f), 1.0f - l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, size, size, glm::radians(45.0f));
-
-            size = l * 2.5f;
-            batch.col(Color(Color::blue).lerp(Color(), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, size, size);
-            batch.col(Color::white);
-        }));
-        jumped->clipSize = 3.0f;
         jumped->lifetime = 0.5f;
         jumped->z = 7.0f;
 
-        smokeSmall = create<EffectType>("fx-smoke-small", create<DrawType>("drawer-fx-smoke-small", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = life.timef();
-            App::ibatch().col(Color(Color::lyellow).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 3, 1.2f, l, [&](float x, float y) {
-                float s = (1.0f - powf(l, 2.0f)) * 0.32f;
-                App::ibatch().draw(atlas.get("white"), pos.x + x, pos.y + y, s, s, glm::radians(45.0f));
-            });
-            App::ibatch().col(Color::white);
-        }));
-        smokeSmall->clipSize = 2.5f;
+        smokeSmall = create<EffectType>("fx-smoke-small", std::vector<EffectEmitter>{
+            EffectEmitter(3, 1.2f, EffectCurve::linear())
+                .sized(EffectCurve::in(2.0f).reversed(), 0.0f, 0.32f)
+                .colored(EffectCurve::linear(), Color::lyellow, Color::gray)
+                .rotated(glm::radians(45.0f))
+        });
         smokeSmall->lifetime = 0.24f;
         smokeSmall->z = 5.0f;
 
-        smokeBig = create<EffectType>("fx-smoke-big", create<DrawType>("drawer-fx-smoke-big", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = life.timef();
-            App::ibatch().col(Color(Color::lyellow).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 4, 2.0f, l, [&](float x, float y) {
-                float s = (1.0f - powf(l, 3.0f)) * 0.5f;
-                App::ibatch().draw(atlas.get("white"), pos.x + x, pos.y + y, s, s, glm::radians(45.0f));
-            });
-            App::ibatch().col(Color::white);
-        }));
-        smokeBig->clipSize = 5.0f;
+        smokeBig = create<EffectType>("fx-smoke-big", std::vector<EffectEmitter>{
+            EffectEmitter(4, 2.0f, EffectCurve::linear())
+                .sized(EffectCurve::in(3.0f).reversed(), 0.0f, 0.5f)
+                .colored(EffectCurve::linear(), Color::lyellow, Color::gray)
+                .rotated(glm::radians(45.0f))
+        });
         smokeBig->lifetime = 0.4f;
         smokeBig->z = 6.0f;
 
-        destructSmall = create<EffectType>("fx-destruct-small", create<DrawType>("drawer-fx-destruct-small", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-            SpriteBatch &batch = App::ibatch();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = 1.0f - powf(1.0f - life.timef(), 2.0f);
-
-            batch.col(Color(Color::lyellow).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 6, 1.2f, l, [&](float x, float y) {
-                float s = (1.0f - l) * 0.4f;
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, s, s);
-            });
-
-            float size = l * 1.2f;
-            batch.col(Color(Color::yellow).lerp(Color(), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, size, size);
-            batch.col(Color::white);
-        }));
-        destructSmall->clipSize = 2.5f;
+        destructSmall = create<EffectType>("fx-destruct-small", std::vector<EffectEmitter>{
+            EffectEmitter(6, 1.2f, EffectCurve::out(2.0f))
+                .sized(fade, 0.0f, 0.4f)
+                .colored(EffectCurve::linear(), Color::lyellow, Color::gray),
+            EffectEmitter(0, 0.0f, EffectCurve::out(2.0f))
+                .sized(EffectCurve::linear(), 0.0f, 1.2f)
+                .colored(EffectCurve::linear(), Color::yellow, Color())
+        });
         destructSmall->lifetime = 0.24f;
         destructSmall->z = 8.0f;
 
-        destructMed = create<EffectType>("fx-destruct-medium", create<DrawType>("drawer-fx-destruct-medium", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-            SpriteBatch &batch = App::ibatch();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = 1.0f - powf(1.0f - life.timef(), 2.5f);
-
-            App::ibatch().col(Color(Color::lorange).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 12, 4.0f, l, [&](float x, float y) {
-                float s = (1.0f - l) * 1.3f;
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, s, s);
-            });
-
-            float size = l * 5.0f;
-            batch.col(Color(Color::orange).lerp(Color(), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, size, size);
-            batch.col(Color::white);
-        }));
-        destructMed->clipSize = 10.0f;
+        destructMed = create<EffectType>("fx-destruct-medium", std::vector<EffectEmitter>{
+            EffectEmitter(12, 4.0f, EffectCurve::out(2.5f))
+                .sized(fade, 0.0f, 1.3f)
+                .colored(EffectCurve::linear(), Color::lorange, Color::gray),
+            EffectEmitter(0, 0.0f, EffectCurve::out(2.5f))
+                .sized(EffectCurve::linear(), 0.0f, 5.0f)
+                .colored(EffectCurve::linear(), Color::orange, Color())
+        });
         destructMed->lifetime = 0.8f;
         destructMed->z = 8.0f;
 
-        destructBig = create<EffectType>("fx-destruct-big", create<DrawType>("drawer-fx-destruct-big", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            TexAtlas &atlas = App::iatlas();
-            SpriteBatch &batch = App::ibatch();
-
-            RigidComp &comp = registry.get<RigidComp>(e);
-            TemporalComp &life = registry.get<TemporalComp>(e);
-            b2Vec2 pos = comp.body->GetPosition();
-
-            float l = 1.0f - powf(1.0f - life.timef(), 3.0f);
-
-            batch.col(Color(Color::lred).lerp(Color::gray, l));
-            Mathf::randVecs((unsigned int)e, 17, 7.0f, l, [&](float x, float y) {
-                float s = (1.0f - l) * 2.0f;
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, s, s);
-            });
-
-            float size = l * 7.0f;
-            batch.col(Color(Color::red).lerp(Color(), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, size, size);
-            batch.col(Color::white);
-        }));
-        destructBig->clipSize = 15.0f;
+        destructBig = create<EffectType>("fx-destruct-big", std::vector<EffectEmitter>{
+            EffectEmitter(17, 7.0f, EffectCurve::out(3.0f))
+                .sized(fade, 0.0f, 2.0f)
+                .colored(EffectCurve::linear(), Color::lred, Color::gray),
+            EffectEmitter(0, 0.0f, EffectCurve::out(3.0f))
+                .sized(EffectCurve::linear(), 0.0f, 7.0f)
+                .colored(EffectCurve::linear(), Color::red, Color())
+        });
         destructBig->lifetime = 1.5f;
         destructBig->z = 9.0f;
 
-        laserDefuse = create<EffectType>("fx-laser-defuse", create<DrawType>("drawer-fx-laser-defuse", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            SpriteBatch &batch = App::ibatch();
-            TexAtlas &atlas = App::iatlas();
-            b2Vec2 pos = registry.get<RigidComp>(e).body->GetPosition();
-            
-            float l = powf(1.0f - registry.get<TemporalComp>(e).timef(), 3.0f);
-
-            batch.col(Color(Color::lpurple).lerp(Color::purple, l));
-            Mathf::randVecs((unsigned int)e, 5, 2.0f, l, [&](float x, float y) {
-                float size = (1.0f - fabs((1.0f - l - 1.0f) * 2.0f + 1.0f)) * 0.5f;
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, size, size, glm::radians(45.0f));
-            });
-
-            batch.draw(atlas.get("white"), pos.x, pos.y, l * 1.25f, l * 1.25f);
-            batch.col(Color::white);
-        }));
+        laserDefuse = create<EffectType>("fx-laser-defuse", std::vector<EffectEmitter>{
+            EffectEmitter(5, 2.0f, EffectCurve::out(3.0f).reversed())
+                .sized(EffectCurve::peak(), 0.0f, 0.5f)
+                .colored(EffectCurve::linear(), Color::lpurple, Color::purple)
+                .rotated(glm::radians(45.0f)),
+            EffectEmitter(0, 0.0f, EffectCurve::out(3.0f).reversed())
+                .sized(EffectCurve::linear(), 0.0f, 1.25f)
+                .colored(EffectCurve::linear(), Color::lpurple, Color::purple)
+        });
         laserDefuse->lifetime = 0.8f;
         laserDefuse->z = 5.5f;
 
-        leaked = create<EffectType>("fx-leaked", create<DrawType>("drawer-fx-leaked", [](entt::entity e) {
-            entt::registry &registry = App::iregistry();
-            SpriteBatch &batch = App::ibatch();
-            TexAtlas &atlas = App::iatlas();
-            b2Vec2 pos = registry.get<RigidComp>(e).body->GetPosition();
-
-            float time = registry.get<TemporalComp>(e).timef();
-
-            float l = 1.0f - powf(1.0f - Mathf::clamp(time * 6.0f), 5.0f);
-            batch.col(Color(Color::lpurple).lerp(Color(Color::purple.r, Color::purple.g, Color::purple.b, 0.0f), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, 8.0f + l * 48.0f, 8.0f + l * 48.0f);
-
-            l = 1.0f - powf(1.0f - Mathf::clamp(time * 3.6f), 5.0f);
-            batch.col(Color(Color::lpurple).lerp(Color(Color::purple.r, Color::purple.g, Color::purple.b, 0.0f), l));
-            batch.draw(atlas.get("white"), pos.x, pos.y, 8.0f + l * 28.0f, 8.0f + l * 28.0f, glm::radians(45.0f));
-
-            l = 1.0f - powf(1.0f - Mathf::clamp(time * 2.0f), 4.0f);
-            Mathf::randVecs((unsigned int)e, 32, 28.0f, l, [&](float x, float y) {
-                batch.col(Color(Color::lyellow).lerp(Color::purple, Mathf::clamp(time * 5.0f)));
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, pos.x + x, pos.y + y, 0.5f, 7.5f * (1.0f - l), glm::orientedAngle(glm::vec2(1.0f, 0.0f), glm::normalize(glm::vec2(x, y))));
-            });
-
-            l = 1.0f - powf(1.0f - Mathf::clamp(time * 1.5f), 3.0f);
-            Mathf::randVecs((unsigned int)e + 1, 24, 17.0f, l, [&](float x, float y) {
-                batch.col(Color(Color::lyellow).lerp(Color::purple, Mathf::clamp(time * 5.0f)));
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, pos.x + x, pos.y + y, 0.375f, 5.0f * (1.0f - l), glm::orientedAngle(glm::vec2(1.0f, 0.0f), glm::normalize(glm::vec2(x, y))));
-            });
-
-            l = 1.0f - powf(1.0f - Mathf::clamp(time * 1.6f), 3.2f);
-            Mathf::randVecs((unsigned int)e + 2, 24, 25.0f, l, [&](float x, float y) {
-                float size = (1.0f - l) * 4.8f;
-
-                batch.col(Color(Color::purple).lerp(Color::gray, Mathf::clamp(time * 1.6f)));
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, size, size, glm::radians(45.0f));
-            });
-
-            l = 1.0f - powf(1.0f - Mathf::clamp(time * 1.3f), 2.4f);
-            Mathf::randVecs((unsigned int)e + 3, 18, 16.0f, l, [&](float x, float y) {
-                float size = (1.0f - l) * 6.0f;
-
-                batch.col(Color(Color::lpurple).lerp(Color::gray, Mathf::clamp(time * 1.3f)));
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, size, size, glm::radians(45.0f));
-            });
-
-            l = 1.0f - powf(1.0f - time, 2.0f);
-            Mathf::randVecs((unsigned int)e + 4, 18, 20.0f, l, [&](float x, float y) {
-                float size = (1.0f - l) * 5.6f;
-
-                batch.col(Color(Color::lyellow).lerp(Color::purple, 1.0f - powf(1.0f - time, 3.0f)));
-                batch.draw(atlas.get("white"), pos.x + x, pos.y + y, size, size, glm::radians(45.0f));
-            });
-
-            batch.col(Color::white);
-        }));
-        leaked->clipSize = 56.0f;
+        leaked = create<EffectType>("fx-leaked", std::vector<EffectEmitter>{
+            EffectEmitter(0, 0.0f, EffectCurve::out(5.0f).scaled(6.0f))
+                .sized(EffectCurve::linear(), 8.0f, 56.0f)
+                .colored(EffectCurve::linear(), Color::lpurple, clearPurple),
+            EffectEmitter(0, 0.0f, EffectCurve::out(5.0f).scaled(3.6f))
+                .sized(EffectCurve::linear(), 8.0f, 36.0f)
+                .colored(EffectCurve::linear(), Color::lpurple, clearPurple)
+                .rotated(glm::radians(45.0f)),
+            EffectEmitter(32, 28.0f, EffectCurve::out(4.0f).scaled(2.0f))
+                .sized(fade, glm::vec2(0.5f, 0.0f), glm::vec2(0.5f, 7.5f))
+                .colored(EffectCurve::linear().scaled(5.0f).overTime(), Color::lyellow, Color::purple)
+                .radiate(),
+            EffectEmitter(24, 17.0f, EffectCurve::out(3.0f).scaled(1.5f))
+                .sized(fade, glm::vec2(0.375f, 0.0f), glm::vec2(0.375f, 5.0f))
+                .colored(EffectCurve::linear().scaled(5.0f).overTime(), Color::lyellow, Color::purple)
+                .radiate(),
+            EffectEmitter(24, 25.0f, EffectCurve::out(3.2f).scaled(1.6f))
+                .sized(fade, 0.0f, 4.8f)
+                .colored(EffectCurve::linear().scaled(1.6f).overTime(), Color::purple, Color::gray)
+                .rotated(glm::radians(45.0f)),
+            EffectEmitter(18, 16.0f, EffectCurve::out(2.4f).scaled(1.3f))
+                .sized(fade, 0.0f, 6.0f)
+                .colored(EffectCurve::linear().scaled(1.3f).overTime(), Color::lpurple, Color::gray)
+                .rotated(glm::radians(45.0f)),
+            EffectEmitter(18, 20.0f, EffectCurve::out(2.0f))
+                .sized(fade, 0.0f, 5.6f)
+                .colored(EffectCurve::out(3.0f).overTime(), Color::lyellow, Color::purple)
+                .rotated(glm::radians(45.0f))
+        });
         leaked->lifetime = 5.6f;
         leaked->z = 10.0f;
+
+        bulletSmall = create<ProjectileType>("proj-bullet-small", "bullet-small", 0.5f, 0.5f, 3.0f);
+        bulletSmall->radius = 0.25f;
+        bulletSmall->mass = 0.196f;
+        bulletSmall->gravityScale = 0.01f;
+        bulletSmall->health = 5.0f;
+        bulletSmall->damage = 10.0f;
+        bulletSmall->deathFx = destructSmall->id;
+        bulletSmall->deathSfx = sfxExplodeSmall;
+
+        bulletMed = create<ProjectileType>("proj-bullet-medium", "bullet-medium", 0.75f, 0.75f, 3.0f);
+        bulletMed->spin = glm::radians(600.0f);
+        bulletMed->radius = 0.5f;
+        bulletMed->mass = 0.785f;
+        bulletMed->gravityScale = 0.04f;
+        bulletMed->health = 10.0f;
+        bulletMed->damage = 20.0f;
+        bulletMed->priority = 2.0f;
+        bulletMed->deathFx = destructSmall->id;
+        bulletMed->deathSfx = sfxExplodeSmall;
+
+        laser = create<ProjectileType>("proj-laser", "laser", 0.25f, 2.0f, 3.0f);
+        // Swept as the 0.25 by 3 box it used to be as a body.
+        laser->radius = 1.5f;
+        laser->halfWidth = 0.125f;
+        laser->mass = 0.15f;
+        laser->health = 5.0f;
+        laser->damage = 10.0f;
+        laser->priority = 10.0f;
+        laser->deathFx = laserDefuse->id;
+        laser->deathSfx = sfxExplodeSmall;
     }
 
     Contents::~Contents() {
         delete contents;
-        Mix_FreeChunk(sfxShootSmall);
-        Mix_FreeChunk(sfxShootMed);
-        Mix_FreeChunk(sfxShootEnergy);
-        Mix_FreeChunk(sfxShootSummon);
-        Mix_FreeChunk(sfxExplodeSmall);
-        Mix_FreeChunk(sfxExplodeMed);
-        Mix_FreeChunk(sfxExplodeBig);
+        for(std::vector<Content *> *list : *indexed) delete list;
+        delete indexed;
+
+        for(Mix_Chunk *chunk : *sounds) {
+            if(chunk != nullptr) Mix_FreeChunk(chunk);
+        }
+        delete sounds;
     }
 
     std::unordered_map<std::string, Content *> *Contents::getBy(CType type) {
@@ -589,18 +410,32 @@ namespace Fantasy {
         return contents->at(ordinal);
     }
 
-    Mix_Chunk *Contents::loadSound(const std::string &path) {
+    std::vector<Content *> *Contents::indexBy(CType type) {
+        int ordinal = (int)type;
+        if(indexed->at(ordinal) == nullptr) indexed->at(ordinal) = new std::vector<Content *>(1, nullptr);
+
+        return indexed->at(ordinal);
+    }
+
+    Mix_Chunk *Contents::getSound(SoundID id) {
+        return sounds->at(id);
+    }
+
+    SoundID Contents::loadSound(const std::string &path) {
         std::string actual("assets/sounds/");
         actual.append(path).append(".ogg");
 
         Mix_Chunk *chunk = Mix_LoadWAV(actual.c_str());
         if(!chunk) throw std::runtime_error(std::string("Couldn't load '").append(actual).append("': ").append(Mix_GetError()).c_str());
 
-        return chunk;
+        sounds->push_back(chunk);
+        return sounds->size() - 1;
     }
 
     Content::Content(const std::string &name) {
         this->name = name;
+        id = 0;
+        type = CType::ALL;
     }
 
     EntityType::EntityType(const std::string &name, const std::function<void(entt::entity)> &initializer): Content(name) {
@@ -618,8 +453,8 @@ namespace Fantasy {
         return CType::ENTITY;
     }
 
-    EffectType::EffectType(const std::string &name, DrawType *drawer): EffectType(name, drawer->name) {}
-    EffectType::EffectType(const std::string &name, const std::string &drawer): EffectType(name,
+    EffectType::EffectType(const std::string &name, DrawType *drawer): EffectType(name, drawer->id) {}
+    EffectType::EffectType(const std::string &name, ContentID drawer): EffectType(name,
         [this](entt::entity e) {
             entt::registry &registry = App::iregistry();
 
@@ -628,36 +463,170 @@ namespace Fantasy {
             bodyDef.gravityScale = 0.0f;
             bodyDef.position.SetZero();
 
-            b2PolygonShape shape;
-            shape.SetAsBox(clipSize / 2.0f, clipSize / 2.0f);
-
-            b2FixtureDef fixt;
-            fixt.shape = &shape;
-            fixt.isSensor = true;
-
+            // The body only carries the effect along; it has no fixtures, the draw clip does the culling.
             b2Body *body = App::iworld().CreateBody(&bodyDef);
-            body->CreateFixture(&fixt);
 
             registry.emplace<RigidComp>(e, e, body);
             registry.emplace<TemporalComp>(e, e, TemporalComp::TIME).time = lifetime;
-            registry.emplace<DrawComp>(e, e, this->drawer).z = z;
+
+            DrawComp &draw = registry.emplace<DrawComp>(e, e, this->drawer);
+            draw.z = z;
+            draw.clip = clipSize;
         }, drawer
     ) {}
     
-    EffectType::EffectType(const std::string &name, const std::function<void(entt::entity)> &initializer, DrawType *drawer): EffectType(name, initializer, drawer->name) {}
-    EffectType::EffectType(const std::string &name, const std::function<void(entt::entity)> &initializer, const std::string &drawer): EntityType(name, initializer) {
+    EffectType::EffectType(const std::string &name, const std::function<void(entt::entity)> &initializer, DrawType *drawer): EffectType(name, initializer, drawer->id) {}
+    EffectType::EffectType(const std::string &name, const std::function<void(entt::entity)> &initializer, ContentID drawer): EntityType(name, initializer) {
         this->drawer = drawer;
         clipSize = 1.0f;
         lifetime = 1.0f;
         z = 1.0f;
     }
 
+    EffectType::EffectType(const std::string &name, const std::vector<EffectEmitter> &emitters): EntityType(name, [this](entt::entity e) {
+        throw std::runtime_error(std::string("'").append(this->name).append("' is drawn on the GPU and has no entity, spawn it with at().").c_str());
+    }) {
+        this->emitters = emitters;
+        drawer = 0;
+        clipSize = 1.0f;
+        lifetime = 1.0f;
+        z = 1.0f;
+    }
+
+    // Parametric effects only leave a spawn record behind, so there's no entity to return for them.
+    entt::entity EffectType::at(const b2Vec2 &pos, const b2Vec2 &velocity) {
+        if(parametric()) {
+            App::icontrol().spawnEffect(id, pos, velocity);
+            return entt::null;
+        }
+
+        entt::registry &registry = App::iregistry();
+        entt::entity fx = create();
+
+        RigidComp *rigid = registry.try_get<RigidComp>(fx);
+        if(rigid != nullptr) {
+            rigid->body->SetTransform(pos, 0.0f);
+            rigid->body->SetLinearVelocity(velocity);
+        } else if(registry.any_of<DrawComp>(fx)) {
+            registry.get<DrawComp>(fx).pos = pos;
+        }
+
+        return fx;
+    }
+
+    bool EffectType::parametric() {
+        return !emitters.empty();
+    }
+
     CType EffectType::ctype() {
         return CType::EFFECT;
     }
 
-    DrawType::DrawType(const std::string &name, const std::function<void(entt::entity)> &drawer): Content(name) {
+    EffectCurve::EffectCurve(Ease ease, float power) {
+        this->ease = ease;
+        this->power = power;
+        speed = 1.0f;
+        reverse = timed = false;
+    }
+
+    EffectCurve EffectCurve::reversed() const {
+        EffectCurve curve = *this;
+        curve.reverse = !reverse;
+        return curve;
+    }
+
+    EffectCurve EffectCurve::scaled(float speed) const {
+        EffectCurve curve = *this;
+        curve.speed = speed;
+        return curve;
+    }
+
+    EffectCurve EffectCurve::overTime() const {
+        EffectCurve curve = *this;
+        curve.timed = true;
+        return curve;
+    }
+
+    EffectCurve EffectCurve::linear() { return EffectCurve(LINEAR, 1.0f); }
+    EffectCurve EffectCurve::in(float power) { return EffectCurve(IN, power); }
+    EffectCurve EffectCurve::out(float power) { return EffectCurve(OUT, power); }
+    EffectCurve EffectCurve::peak() { return EffectCurve(PEAK, 1.0f); }
+
+    EffectEmitter::EffectEmitter(int count, float radius, const EffectCurve &spread):
+        spread(spread), size(EffectCurve::linear()), color(EffectCurve::linear()) {
+        this->count = count;
+        this->radius = radius;
+        angle = 0.0f;
+        radial = false;
+        sizeFrom = sizeTo = glm::vec2(1.0f, 1.0f);
+        colorFrom = colorTo = Color::white;
+    }
+
+    EffectEmitter EffectEmitter::sized(const EffectCurve &curve, float from, float to) const {
+        return sized(curve, glm::vec2(from, from), glm::vec2(to, to));
+    }
+
+    EffectEmitter EffectEmitter::sized(const EffectCurve &curve, const glm::vec2 &from, const glm::vec2 &to) const {
+        EffectEmitter emitter = *this;
+        emitter.size = curve;
+        emitter.sizeFrom = from;
+        emitter.sizeTo = to;
+        return emitter;
+    }
+
+    EffectEmitter EffectEmitter::colored(const EffectCurve &curve, const Color &from, const Color &to) const {
+        EffectEmitter emitter = *this;
+        emitter.color = curve;
+        emitter.colorFrom = from;
+        emitter.colorTo = to;
+        return emitter;
+    }
+
+    EffectEmitter EffectEmitter::rotated(float angle) const {
+        EffectEmitter emitter = *this;
+        emitter.angle = angle;
+        return emitter;
+    }
+
+    EffectEmitter EffectEmitter::radiate() const {
+        EffectEmitter emitter = *this;
+        emitter.radial = true;
+        return emitter;
+    }
+
+    ProjectileType::ProjectileType(const std::string &name, const std::string &region, float width, float height, float z): Content(name) {
+        this->region = region;
+        this->width = width;
+        this->height = height;
+        this->z = z;
+        spin = 0.0f;
+        radius = 0.25f;
+        halfWidth = 0.0f;
+        mass = 1.0f;
+        gravityScale = 0.0f;
+        health = 1.0f;
+        damage = 0.0f;
+        priority = 1.0f;
+        deathFx = 0;
+        deathSfx = 0;
+        regionTex = nullptr;
+    }
+
+    const TexRegion &ProjectileType::getRegion() {
+        if(regionTex == nullptr) regionTex = &App::iatlas().get(region);
+        return *regionTex;
+    }
+
+    CType ProjectileType::ctype() {
+        return CType::PROJECTILE;
+    }
+
+    DrawType::DrawType(const std::string &name, const std::function<void(const RenderItem &)> &drawer): Content(name) {
         this->drawer = drawer;
+        period = 0.0f;
+        extent = 0.0f;
+        frames = 0;
+        variants = 1;
     }
 
     CType DrawType::ctype() {
@@ -7,22 +7,33 @@
 #include <functional>
 #include <stdexcept>
 #include <string>
+#include <typeinfo>
 #include <entt/entity/registry.hpp>
 #include <box2d/box2d.h>
+#include <glm/vec2.hpp>
 
 #include "../graphics/tex_atlas.h"
+#include "../graphics/color.h"
 
 namespace Fantasy {
-    enum class CType {
+    typedef unsigned short ContentID;
+    typedef unsigned char SoundID;
+
+    struct RenderItem;
+
+    enum class CType: unsigned char {
         ENTITY,
         DRAW,
         EFFECT,
+        PROJECTILE,
         ALL
     };
 
     class Content {
         public:
         std::string name;
+        ContentID id;
+        CType type;
 
         public:
         Content(const Content &) = delete;
@@ -40,45 +51,135 @@ namespace Fantasy {
         static CType ctype();
     };
 
+    // A looping drawer has a period; its items' progress is then the time into the loop, and it has to look the same at 0
+    // and `period`. If it sets `frames`, the renderer bakes it into that many frames of a square `extent` units wide around
+    // the item, one set per variant, drawing variant `i` as entity `i` and every entity as its ID modulo `variants`.
+    // Frames are baked unrotated at unit width and height, then rotated and stretched by the item's own; anything else
+    // it varies by is lost. Drawers whose frames don't fit the flipbook budget are drawn live.
     class DrawType: public Content {
         public:
-        std::function<void(entt::entity)> drawer;
+        std::function<void(const RenderItem &)> drawer;
+        float period, extent;
+        int frames, variants;
 
         public:
-        DrawType(const std::string &, const std::function<void(entt::entity)> &);
+        DrawType(const std::string &, const std::function<void(const RenderItem &)> &);
 
         static CType ctype();
     };
 
+    // Maps an input in [0, 1] to [0, 1]. The input is the emitter's spread unless timed, in which case it's the effect's
+    // own progress; speed scales it before clamping.
+    struct EffectCurve {
+        public:
+        enum Ease: unsigned char {
+            LINEAR,
+            IN,
+            OUT,
+            PEAK
+        };
+
+        Ease ease;
+        float power, speed;
+        bool reverse, timed;
+
+        public:
+        EffectCurve(Ease, float);
+
+        EffectCurve reversed() const;
+        EffectCurve scaled(float) const;
+        EffectCurve overTime() const;
+
+        static EffectCurve linear();
+        static EffectCurve in(float);
+        static EffectCurve out(float);
+        static EffectCurve peak();
+    };
+
+    // A burst of `count` squares of the atlas' white region flying out up to `radius` as the spread curve goes from 0
+    // to 1, or a single one at the origin when the count is 0. Size and color are interpolated along their curves;
+    // radial particles are pivoted on their corner and turned to face away from the origin.
+    struct EffectEmitter {
+        public:
+        int count;
+        float radius, angle;
+        bool radial;
+
+        EffectCurve spread, size, color;
+        glm::vec2 sizeFrom, sizeTo;
+        Color colorFrom, colorTo;
+
+        public:
+        EffectEmitter(int, float, const EffectCurve &);
+
+        EffectEmitter sized(const EffectCurve &, float, float) const;
+        EffectEmitter sized(const EffectCurve &, const glm::vec2 &, const glm::vec2 &) const;
+        EffectEmitter colored(const EffectCurve &, const Color &, const Color &) const;
+        EffectEmitter rotated(float) const;
+        EffectEmitter radiate() const;
+    };
+
+    // Either drawn by a drawer on an entity of its own, or described by emitters that the renderer evaluates entirely
+    // on the GPU from the spawn alone.
     class EffectType: public EntityType {
         public:
         float clipSize, lifetime, z;
-        std::string drawer;
+        ContentID drawer;
+        std::vector<EffectEmitter> emitters;
 
         public:
-        EffectType(const std::string &, const std::string &);
+        EffectType(const std::string &, ContentID);
         EffectType(const std::string &, DrawType *);
-        EffectType(const std::string &, const std::function<void(entt::entity)> &, const std::string &);
+        EffectType(const std::string &, const std::function<void(entt::entity)> &, ContentID);
         EffectType(const std::string &, const std::function<void(entt::entity)> &, DrawType *);
+        EffectType(const std::string &, const std::vector<EffectEmitter> &);
+
+        entt::entity at(const b2Vec2 &, const b2Vec2 &velocity = b2Vec2(0.0f, 0.0f));
+        bool parametric();
 
         static CType ctype();
     };
 
+    // Hits whatever is within `radius` ahead of its center or `halfWidth` to either side, other teams' projectiles
+    // included, and is targeted with `priority` like an entity's TeamComp.
+    class ProjectileType: public Content {
+        public:
+        std::string region;
+        float width, height, z, spin;
+        float radius, halfWidth, mass, gravityScale, health, damage, priority;
+
+        ContentID deathFx;
+        SoundID deathSfx;
+
+        private:
+        const TexRegion *regionTex;
+
+        public:
+        ProjectileType(const std::string &, const std::string &, float, float, float);
+
+        const TexRegion &getRegion();
+        static CType ctype();
+    };
+
     class Contents {
         private:
         std::vector<std::unordered_map<std::string, Content *> *> *contents;
+        std::vector<std::vector<Content *> *> *indexed;
+        std::vector<Mix_Chunk *> *sounds;
 
         public:
-        Mix_Chunk
-            *sfxShootSmall, *sfxShootMed, *sfxShootEnergy, *sfxShootSummon,
-            *sfxExplodeSmall, *sfxExplodeMed, *sfxExplodeBig;
+        SoundID
+            sfxShootSmall, sfxShootMed, sfxShootEnergy, sfxShootSummon,
+            sfxExplodeSmall, sfxExplodeMed, sfxExplodeBig;
 
         DrawType
             *genericRegion, *drawJumper, *drawLeak;
 
         EntityType
-            *jumper, *spike, *leak,
-            *bulletSmall, *bulletMed, *bulletLeak, *laser;
+            *jumper, *spike, *leak, *bulletLeak;
+
+        ProjectileType
+            *bulletSmall, *bulletMed, *laser;
 
         EffectType
             *jumped,
@@ -104,6 +205,11 @@ namespace Fantasy {
                 map->emplace(content->name, content);
             }
 
+            std::vector<Content *> *list = indexBy(T::ctype());
+            content->id = list->size();
+            content->type = T::ctype();
+            list->push_back(content);
+
             return content;
         }
 
@@ -119,10 +225,25 @@ namespace Fantasy {
             }
         }
 
+        template<typename T, typename std::enable_if<std::is_base_of<Content, T>::value>::type *_T = nullptr>
+        T *getById(ContentID id) {
+            std::vector<Content *> *list = indexBy(T::ctype());
+            if(id == 0 || id >= list->size()) throw std::runtime_error(std::string("'").append(typeid(T).name()).append("' with ID ").append(std::to_string(id)).append(" doesn't exist.").c_str());
+
+            return (T *)list->at(id);
+        }
+
+        template<typename T, typename std::enable_if<std::is_base_of<Content, T>::value>::type *_T = nullptr>
+        bool has(const std::string &name) {
+            return !name.empty() && getBy(T::ctype())->count(name);
+        }
+
         std::unordered_map<std::string, Content *> *getBy(CType);
+        std::vector<Content *> *indexBy(CType);
+        Mix_Chunk *getSound(SoundID);
 
         private:
-        Mix_Chunk *loadSound(const std::string &path);
+        SoundID loadSound(const std::string &path);
     };
 }
 
@@ -0,0 +1,323 @@
+#include <SDL.h>
+#include <GL/glew.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "effect_layer.h"
+#include "time.h"
+#include "../app.h"
+#include "../graphics/sprite_batch.h"
+
+// The emitter is 9 vectors, packed by EffectLayer: count, radius, angle and radial; the spread, size and color curves
+// as speed, power, ease and flags (1 reversed, 2 over time); size from and to; color from and to; the region's
+// coordinates; then lifetime, seed offset and array layer.
+static constexpr const char *EFFECT_VERTEX_SHADER = R"(
+#version 150 core
+
+in vec2 a_position;
+in uint a_particle;
+in vec2 a_origin;
+in vec2 a_velocity;
+in float a_spawn;
+in uint a_seed;
+
+out vec3 v_tex_coords;
+out vec4 v_color;
+out vec4 v_tint;
+
+layout(std140) uniform Frame {
+    mat4 u_proj;
+    vec2 u_resolution;
+    vec2 u_camera;
+    vec2 u_zoom;
+    float u_time;
+};
+
+uniform vec4 u_emitter[9];
+
+// The same hash as Mathf::snext, so particles go where the CPU drawers used to put them.
+float unit(uint state) {
+    uint x = state;
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return float(x) / 4294967295.0;
+}
+
+float curve(vec4 curve, float spread, float time) {
+    int flags = int(curve.w);
+    float x = clamp(((flags & 2) != 0 ? time : spread) * curve.x, 0.0, 1.0);
+
+    int ease = int(curve.z);
+    float y = ease == 1 ? pow(x, curve.y) : ease == 2 ? 1.0 - pow(1.0 - x, curve.y) : ease == 3 ? 1.0 - abs(1.0 - 2.0 * x) : x;
+    return (flags & 1) != 0 ? 1.0 - y : y;
+}
+
+void main() {
+    vec4 shape = u_emitter[0];
+    vec4 timing = u_emitter[8];
+
+    float age = u_time - a_spawn;
+    float time = clamp(age / timing.x, 0.0, 1.0);
+    float spread = curve(u_emitter[1], time, time);
+
+    vec2 offset = vec2(0.0);
+    if(shape.x > 0.0) {
+        uint state = a_seed + uint(timing.y) + (2u * a_particle + 1u) * 0x9e3779b9u;
+        float angle = unit(state) * 6.2831855;
+        float len = unit(state + 0x9e3779b9u) * shape.y * spread;
+        offset = vec2(cos(angle), sin(angle)) * len;
+    }
+
+    vec2 size = mix(u_emitter[4].xy, u_emitter[4].zw, curve(u_emitter[2], spread, time));
+    float rotation = shape.z;
+    vec2 local;
+    if(shape.w > 0.0) {
+        rotation += atan(offset.y, offset.x);
+        local = a_position * size;
+    } else {
+        local = (a_position - 0.5) * size;
+    }
+
+    float s = sin(rotation), c = cos(rotation);
+    vec2 world = a_origin + a_velocity * age + offset + vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    gl_Position = u_proj * vec4(world, 1.0, 1.0);
+    v_tex_coords = vec3(mix(u_emitter[7].xy, u_emitter[7].zw, a_position), timing.z);
+    v_color = mix(u_emitter[5], u_emitter[6], curve(u_emitter[3], spread, time));
+    v_tint = vec4(0.0);
+})";
+
+namespace Fantasy {
+    const size_t EffectLayer::recordSize = 6;
+    const size_t EffectLayer::emitterSize = 9 * 4;
+
+    static void packCurve(float *out, const EffectCurve &curve) {
+        out[0] = curve.speed;
+        out[1] = curve.power;
+        out[2] = (float)curve.ease;
+        out[3] = (float)((curve.reverse ? 1 : 0) | (curve.timed ? 2 : 0));
+    }
+
+    EffectLayer::EffectLayer(Contents &content, const TexRegion &region) {
+        rings = new std::vector<Ring *>();
+        emitters = new std::vector<float>();
+        this->region = &region;
+        resetTime = -1.0f;
+        draws = 0;
+        grows = 0;
+
+        std::vector<Content *> &effects = *content.indexBy(CType::EFFECT);
+        byType = new std::vector<Ring *>(effects.size(), nullptr);
+
+        int maxCount = 1;
+        for(size_t i = 1; i < effects.size(); i++) {
+            EffectType *type = (EffectType *)effects[i];
+            if(!type->parametric()) continue;
+            if(type->emitters.size() > 16) throw std::runtime_error(std::string("'").append(type->name).append("' has more than 16 emitters.").c_str());
+
+            Ring *ring = new Ring();
+            ring->type = type;
+            ring->emitter = emitters->size() / emitterSize;
+            ring->instances = nullptr;
+            ring->records = new std::vector<float>();
+            ring->head = ring->count = ring->capacity = ring->fresh = 0;
+
+            for(size_t e = 0; e < type->emitters.size(); e++) {
+                const EffectEmitter &emitter = type->emitters[e];
+                maxCount = std::max(maxCount, emitter.count);
+
+                float packed[emitterSize] = {
+                    (float)emitter.count, emitter.radius, emitter.angle, emitter.radial ? 1.0f : 0.0f,
+                    0.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 0.0f, 0.0f,
+                    0.0f, 0.0f, 0.0f, 0.0f,
+                    emitter.sizeFrom.x, emitter.sizeFrom.y, emitter.sizeTo.x, emitter.sizeTo.y,
+                    emitter.colorFrom.r, emitter.colorFrom.g, emitter.colorFrom.b, emitter.colorFrom.a,
+                    emitter.colorTo.r, emitter.colorTo.g, emitter.colorTo.b, emitter.colorTo.a,
+                    region.u, region.v, region.u2, region.v2,
+                    type->lifetime, (float)e, (float)region.layer, 0.0f
+                };
+
+                packCurve(packed + 4, emitter.spread);
+                packCurve(packed + 8, emitter.size);
+                packCurve(packed + 12, emitter.color);
+                emitters->insert(emitters->end(), packed, packed + emitterSize);
+            }
+
+            grow(ring);
+            rings->push_back(ring);
+            byType->at(i) = ring;
+        }
+
+        std::stable_sort(rings->begin(), rings->end(), [](const Ring *a, const Ring *b) { return a->type->z < b->type->z; });
+
+        // One quad per particle, each knowing its index; the emitter draws as many as it has.
+        std::vector<float> vertices(maxCount * 4 * 3);
+        std::vector<unsigned short> indices(maxCount * 6);
+        float corners[] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+
+        for(int i = 0; i < maxCount; i++) {
+            for(int j = 0; j < 4; j++) {
+                float *out = vertices.data() + (i * 4 + j) * 3;
+                out[0] = corners[j * 2];
+                out[1] = corners[j * 2 + 1];
+                writeBits(out + 2, (unsigned int)i);
+            }
+
+            unsigned short *quad = indices.data() + i * 6;
+            quad[0] = i * 4;
+            quad[1] = i * 4 + 1;
+            quad[2] = i * 4 + 2;
+            quad[3] = i * 4 + 2;
+            quad[4] = i * 4 + 3;
+            quad[5] = i * 4;
+        }
+
+        particles = new Mesh(maxCount * 4, maxCount * 6, 2, new VertexAttr[2]{
+            VertexAttr::position2D,
+            VertexAttr::integral(1, GL_UNSIGNED_INT, "a_particle")
+        });
+        particles->setVertices(vertices.data(), 0, vertices.size());
+        particles->setIndices(indices.data(), 0, indices.size());
+
+        shader = SpriteBatch::createShader(EFFECT_VERTEX_SHADER, false);
+        arrayShader = SpriteBatch::createShader(EFFECT_VERTEX_SHADER, true);
+    }
+
+    EffectLayer::~EffectLayer() {
+        for(Ring *ring : *rings) {
+            delete ring->instances;
+            delete ring->records;
+            delete ring;
+        }
+
+        delete rings;
+        delete byType;
+        delete emitters;
+        delete particles;
+        delete shader;
+        delete arrayShader;
+    }
+
+    void EffectLayer::update(const RenderSnapshot &snap) {
+        if(snap.resetTime != resetTime) {
+            for(Ring *ring : *rings) ring->head = ring->count = 0;
+            resetTime = snap.resetTime;
+        }
+
+        float now = Time::time();
+        for(Ring *ring : *rings) {
+            while(ring->count > 0 && now - ring->records->at(ring->head * recordSize + 4) >= ring->type->lifetime) {
+                ring->head = (ring->head + 1) % ring->capacity;
+                ring->count--;
+            }
+        }
+
+        for(const EffectInstance &effect : snap.effects) {
+            Ring *ring = byType->at(effect.effect);
+            if(ring == nullptr) continue;
+            if(ring->count == ring->capacity) grow(ring);
+
+            float *out = ring->records->data() + ((ring->head + ring->count) % ring->capacity) * recordSize;
+            out[0] = effect.pos.x;
+            out[1] = effect.pos.y;
+            out[2] = effect.velocity.x;
+            out[3] = effect.velocity.y;
+            out[4] = effect.time;
+            writeBits(out + 5, effect.seed);
+
+            ring->count++;
+            ring->fresh++;
+        }
+
+        // Only the spawns go to the GPU, at most two writes per type when the ring wraps.
+        for(Ring *ring : *rings) {
+            if(ring->fresh == 0) continue;
+
+            upload(ring, (ring->head + ring->count - ring->fresh) % ring->capacity, ring->fresh);
+            ring->fresh = 0;
+        }
+    }
+
+    void EffectLayer::draw() {
+        draws = 0;
+
+        Shader *program = region->texture->layered() ? arrayShader : shader;
+        program->bind();
+        App::iuniforms().upload();
+        region->texture->active(0);
+
+        for(Ring *ring : *rings) {
+            if(ring->count == 0) continue;
+
+            size_t first = std::min(ring->count, ring->capacity - ring->head);
+            for(size_t e = 0; e < ring->type->emitters.size(); e++) {
+                glUniform4fv(program->uniform(Uniform::EMITTER), 9, emitters->data() + (ring->emitter + e) * emitterSize);
+                size_t indices = std::max(ring->type->emitters[e].count, 1) * 6;
+
+                ring->instances->first(ring->head);
+                particles->render(program, GL_TRIANGLES, 0, indices, ring->instances, first);
+                draws++;
+
+                if(first < ring->count) {
+                    ring->instances->first(0);
+                    particles->render(program, GL_TRIANGLES, 0, indices, ring->instances, ring->count - first);
+                    draws++;
+                }
+            }
+        }
+    }
+
+    void EffectLayer::log() {
+        size_t live = 0, capacity = 0;
+        for(Ring *ring : *rings) {
+            live += ring->count;
+            capacity += ring->capacity;
+        }
+
+        SDL_Log(
+            "[effects] %zu live of %zu instance slots over %zu types, %zu draws last frame, %zu rings grown so far.",
+            live, capacity, rings->size(), draws, grows
+        );
+    }
+
+    void EffectLayer::upload(Ring *ring, size_t from, size_t count) {
+        size_t until = std::min(count, ring->capacity - from);
+        ring->instances->updateVertices(ring->records->data() + from * recordSize, from * recordSize, until * recordSize);
+        if(until < count) ring->instances->updateVertices(ring->records->data(), 0, (count - until) * recordSize);
+    }
+
+    // Doubles the ring, laying the live instances out from the start again; the whole lot is uploaded anew.
+    void EffectLayer::grow(Ring *ring) {
+        size_t capacity = ring->capacity == 0 ? 64 : ring->capacity * 2;
+        std::vector<float> *records = new std::vector<float>(capacity * recordSize);
+
+        for(size_t i = 0; i < ring->count; i++) {
+            const float *from = ring->records->data() + ((ring->head + i) % ring->capacity) * recordSize;
+            std::copy(from, from + recordSize, records->data() + i * recordSize);
+        }
+
+        Mesh *instances = new Mesh(capacity, 0, 4, new VertexAttr[4]{
+            VertexAttr(2, GL_FLOAT, "a_origin"),
+            VertexAttr(2, GL_FLOAT, "a_velocity"),
+            VertexAttr(1, GL_FLOAT, "a_spawn"),
+            VertexAttr::integral(1, GL_UNSIGNED_INT, "a_seed")
+        });
+        if(ring->count > 0) instances->updateVertices(records->data(), 0, ring->count * recordSize);
+
+        if(ring->instances != nullptr) {
+            delete ring->instances;
+            grows++;
+        }
+
+        delete ring->records;
+        ring->records = records;
+        ring->instances = instances;
+        ring->capacity = capacity;
+        ring->head = 0;
+        ring->fresh = 0;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef EFFECT_LAYER_H
+#define EFFECT_LAYER_H
+
+#include <vector>
+
+#include "../graphics/mesh.h"
+#include "../graphics/shader.h"
+#include "../graphics/tex_atlas.h"
+#include "content.h"
+#include "snapshot.h"
+
+namespace Fantasy {
+    // Parametric effects, evaluated entirely in the vertex shader from their spawn records. Every effect type keeps its
+    // live instances in a ring, which works since instances of one type all live equally long and so expire in spawn
+    // order. A frame then costs one instanced draw per emitter of each type that has anything alive.
+    class EffectLayer {
+        private:
+        struct Ring {
+            EffectType *type;
+            size_t emitter;
+            Mesh *instances;
+            std::vector<float> *records;
+            size_t head, count, capacity;
+            // Spawned since the last upload, at the end of the live range.
+            size_t fresh;
+        };
+
+        static const size_t recordSize;
+        static const size_t emitterSize;
+
+        std::vector<Ring *> *rings;
+        std::vector<Ring *> *byType;
+        std::vector<float> *emitters;
+        Mesh *particles;
+        Shader *shader;
+        Shader *arrayShader;
+        const TexRegion *region;
+        float resetTime;
+        size_t draws;
+        size_t grows;
+
+        public:
+        EffectLayer(Contents &, const TexRegion &);
+        ~EffectLayer();
+
+        void update(const RenderSnapshot &);
+        void draw();
+        void log();
+
+        private:
+        void upload(Ring *, size_t, size_t);
+        void grow(Ring *);
+    };
+}
+
+#endif
@@ -13,36 +13,34 @@ namespace Fantasy {
     void Component::remove() { App::icontrol().scheduleRemoval(ref); }
     entt::entity Component::getRef() { return ref; }
 
-    entt::entity Component::createFx(const std::string &effect, bool follow) {
+    entt::entity Component::createFx(ContentID effect, bool follow) {
         entt::registry &registry = App::iregistry();
-        entt::entity fx = App::icontent().getByName<EffectType>(effect)->create();
+        EffectType *type = App::icontent().getById<EffectType>(effect);
 
-        if(registry.any_of<RigidComp>(ref)) {
-            RigidComp &other = registry.get<RigidComp>(fx);
-            RigidComp &self = registry.get<RigidComp>(ref);
+        RigidComp *self = registry.try_get<RigidComp>(ref);
+        if(self == nullptr) return type->at(b2Vec2(0.0f, 0.0f));
 
-            other.body->SetTransform(self.body->GetPosition(), 0.0f);
-            if(follow) other.body->SetLinearVelocity(self.body->GetLinearVelocity());
-        }
-
-        return fx;
+        return type->at(self->body->GetPosition(), follow ? self->body->GetLinearVelocity() : b2Vec2(0.0f, 0.0f));
     }
 
-    int Component::createSfx(Mix_Chunk *sound) {
+    int Component::createSfx(SoundID sound) {
         entt::registry &registry = App::iregistry();
-        int channel = Mix_PlayChannel(-1, sound, 0);
-        if(channel < 0) return channel;
+        if(registry.any_of<RigidComp>(ref)) return createSfx(sound, registry.get<RigidComp>(ref).body->GetPosition());
 
-        if(registry.any_of<RigidComp>(ref)) {
-            b2Vec2 pos = b2Vec2(App::irenderer().pos.x, App::irenderer().pos.y) - registry.get<RigidComp>(ref).body->GetPosition();
-            float angle = glm::degrees(glm::orientedAngle(glm::vec2(0.0f, 1.0f), glm::normalize(glm::vec2(pos.x, pos.y))));
-            angle = fmodf(angle, 360.0f);
-            angle += 360.0f;
-            angle = fmodf(angle, 360.0f);
+        return Mix_PlayChannel(-1, App::icontent().getSound(sound), 0);
+    }
 
-            Mix_SetPosition(channel, angle, pos.Length() * 2.0f);
-        }
+    int Component::createSfx(SoundID sound, const b2Vec2 &source) {
+        int channel = Mix_PlayChannel(-1, App::icontent().getSound(sound), 0);
+        if(channel < 0) return channel;
 
+        b2Vec2 pos = App::icontrol().getFocus() - source;
+        float angle = glm::degrees(glm::orientedAngle(glm::vec2(0.0f, 1.0f), glm::normalize(glm::vec2(pos.x, pos.y))));
+        angle = fmodf(angle, 360.0f);
+        angle += 360.0f;
+        angle = fmodf(angle, 360.0f);
+
+        Mix_SetPosition(channel, angle, pos.Length() * 2.0f);
         return channel;
     }
 
@@ -51,17 +49,16 @@ namespace Fantasy {
         this->body->GetUserData().pointer = (uintptr_t)ref;
         rotateSpeed = 0.0f;
         spawned = false;
-        spawnSfx = deathSfx = nullptr;
     }
 
     void RigidComp::update() {
         if(!spawned) {
             spawned = true;
-            if(!spawnFx.empty()) createFx(spawnFx);
-            if(spawnSfx) createSfx(spawnSfx);
-        }
 
-        if(!Mathf::near(rotateSpeed, 0.0f)) body->SetTransform(body->GetPosition(), body->GetAngle() + rotateSpeed);
+            FxComp *fx = App::iregistry().try_get<FxComp>(ref);
+            if(fx != nullptr) fx->spawned();
+            if(!Mathf::near(rotateSpeed, 0.0f)) body->SetAngularVelocity(rotateSpeed);
+        }
     }
 
     void RigidComp::beginCollide(RigidComp &other) {
@@ -89,37 +86,89 @@ namespace Fantasy {
     }
 
     void RigidComp::onDestroy(entt::registry &registry, entt::entity entity) {
-        RigidComp &comp = registry.get<RigidComp>(entity);
-        if(!App::icontrol().isResetting()) {
-            if(!comp.deathFx.empty()) comp.createFx(comp.deathFx);
-            if(comp.deathSfx) comp.createSfx(comp.deathSfx);
-        }
+        App::iworld().DestroyBody(registry.get<RigidComp>(entity).body);
+    }
 
-        App::iworld().DestroyBody(comp.body);
+    FxComp::FxComp(entt::entity e): Component(e) {
+        spawnFx = deathFx = 0;
+        spawnSfx = deathSfx = 0;
     }
 
-    DrawComp::DrawComp(entt::entity e, const std::string &drawer): DrawComp(e, drawer, 1.0f, 1.0f) {}
-    DrawComp::DrawComp(entt::entity e, const std::string &drawer, float size): DrawComp(e, drawer, size, size) {}
-    DrawComp::DrawComp(entt::entity e, const std::string &drawer, float width, float height): DrawComp(e, drawer, width, height, 0.0f) {}
-    DrawComp::DrawComp(entt::entity e, const std::string &drawer, float width, float height, float z): Component(e) {
+    void FxComp::spawned() {
+        if(spawnFx) createFx(spawnFx);
+        if(spawnSfx) createSfx(spawnSfx);
+    }
+
+    void FxComp::died() {
+        if(deathFx) createFx(deathFx);
+        if(deathSfx) createSfx(deathSfx);
+    }
+
+    DrawComp::DrawComp(entt::entity e, ContentID drawer): DrawComp(e, drawer, 1.0f, 1.0f) {}
+    DrawComp::DrawComp(entt::entity e, ContentID drawer, float size): DrawComp(e, drawer, size, size) {}
+    DrawComp::DrawComp(entt::entity e, ContentID drawer, float width, float height): DrawComp(e, drawer, width, height, 0.0f) {}
+    DrawComp::DrawComp(entt::entity e, ContentID drawer, float width, float height, float z): Component(e) {
         this->drawer = drawer;
         this->width = width;
         this->height = height;
         this->z = z;
-        region = std::nullopt;
+        region = 0;
+        spin = 0.0f;
+        clip = 0.0f;
+        pos.SetZero();
+        angle = 0.0f;
+        retained = false;
+        initTime = Time::time();
     }
 
-    void DrawComp::update() {
+    void DrawComp::extract(RenderItem &item) {
         entt::registry &registry = App::iregistry();
-        b2Transform trns = registry.get<RigidComp>(ref).body->GetTransform();
+        RigidComp *rigid = registry.try_get<RigidComp>(ref);
+        float time = Time::time();
 
-        if(registry.any_of<HealthComp>(ref)) {
-            float alpha = fmaxf(1.0f - (Time::time() - registry.get<HealthComp>(ref).hitTime) / 0.5f, 0.0f);
-            App::ibatch().tint(Color(0.8f, 0.0f, 0.1f, alpha));
+        item.entity = ref;
+        item.drawer = drawer;
+        item.region = region;
+        item.pos = rigid == nullptr ? pos : rigid->body->GetPosition();
+        item.rotation = rotation();
+        item.width = width;
+        item.height = height;
+        item.z = z;
+
+        HealthComp *health = registry.try_get<HealthComp>(ref);
+        item.hit = health == nullptr ? 0.0f : fmaxf(1.0f - (time - health->hitTime) / 0.5f, 0.0f);
+        item.health = (health == nullptr || !health->showBar || !health->canHurt()) ? -1.0f : health->health / health->maxHealth;
+
+        // Culled by what gets drawn rather than by fixtures: the sprite at any rotation, the clip square, and the
+        // health bar below it.
+        float extent = fmaxf(sqrtf(width * width + height * height), clip) / 2.0f;
+        item.bound.lowerBound = item.pos - b2Vec2(extent, extent);
+        item.bound.upperBound = item.pos + b2Vec2(extent, extent);
+        if(item.health >= 0.0f) {
+            b2AABB bar;
+            bar.lowerBound = item.pos + b2Vec2(-0.625f, -1.075f);
+            bar.upperBound = item.pos + b2Vec2(0.625f, -0.95f);
+            item.bound.Combine(bar);
         }
 
-        App::icontent().getByName<DrawType>(drawer)->drawer(ref);
-        App::ibatch().tint(Color());
+        TemporalComp *life = registry.try_get<TemporalComp>(ref);
+        JumpComp *jump = registry.try_get<JumpComp>(ref);
+        item.progress = life == nullptr ? 0.0f : life->timef();
+        item.seed = 0.0f;
+
+        if(jump != nullptr) {
+            item.progress = jump->isHolding() ? fminf((time - jump->getTime()) / jump->timeout, 1.0f) : -1.0f;
+            item.seed = jump->getTime();
+        }
+
+        // Offset per entity, so look-alike variants of a looping drawer don't move in step.
+        DrawType *type = App::icontent().getById<DrawType>(drawer);
+        if(type->period > 0.0f) item.progress = fmodf(time + Mathf::srandom((unsigned int)ref, type->period), type->period);
+    }
+
+    float DrawComp::rotation() {
+        RigidComp *rigid = App::iregistry().try_get<RigidComp>(ref);
+        return (rigid == nullptr ? angle : rigid->body->GetAngle()) + spin * (Time::time() - initTime);
     }
 
     JumpComp::JumpComp(entt::entity e, float force, float timeout): Component(e) {
@@ -128,7 +177,8 @@ namespace Fantasy {
         holding = false;
         jumping = false;
         time = -1.0f;
-        sound = nullptr;
+        effect = 0;
+        sound = 0;
     }
 
     void JumpComp::hold() {
@@ -171,7 +221,7 @@ namespace Fantasy {
                 body->GetPosition().y + Mathf::random(-0.1f, 0.1f)
             ), true);
 
-            if(!effect.empty()) createFx(effect);
+            if(effect) createFx(effect);
         }
     }
 
@@ -230,23 +280,28 @@ namespace Fantasy {
         this->priority = priority;
     }
 
-    ShooterComp::ShooterComp(entt::entity e, const std::string &bullet, float rate): ShooterComp(e, bullet, rate, 4.0f) {}
-    ShooterComp::ShooterComp(entt::entity e, const std::string &bullet, float rate, float impulse): ShooterComp(e, bullet, rate, impulse, 20.0f) {}
-    ShooterComp::ShooterComp(entt::entity e, const std::string &bullet, float rate, float impulse, float range): Component(e) {
-        this->bullet = bullet;
+    ShooterComp::ShooterComp(entt::entity e, const Content *bullet, float rate): ShooterComp(e, bullet, rate, 4.0f) {}
+    ShooterComp::ShooterComp(entt::entity e, const Content *bullet, float rate, float impulse): ShooterComp(e, bullet, rate, impulse, 20.0f) {}
+    ShooterComp::ShooterComp(entt::entity e, const Content *bullet, float rate, float impulse, float range): Component(e) {
+        this->bullet = bullet->id;
+        bulletType = bullet->type;
         this->rate = rate;
         this->impulse = impulse;
         this->range = range;
         lastShoot = timer = Time::time();
         inaccuracy = 0.0f;
-        shootSfx = nullptr;
+        target.SetZero();
+        aiming = false;
+        shootFx = 0;
+        shootSfx = 0;
     }
 
-    void ShooterComp::update() {
+    void ShooterComp::aim() {
         entt::registry &regist = App::iregistry();
         b2World &world = App::iworld();
         b2Body *body = regist.get<RigidComp>(ref).body;
 
+        aiming = false;
         float time = Time::time();
         if(time - lastShoot >= rate && time - timer >= 0.1f) {
             timer = time;
@@ -258,14 +313,18 @@ namespace Fantasy {
                 float radius;
                 Team::TeamType team;
 
-                b2Body *closest;
+                b2Vec2 closest;
+                float score;
+                bool found;
 
                 public:
                 Report(b2Vec2 origin, float radius, Team::TeamType team) {
                     this->origin = origin;
                     this->radius = radius * radius;
                     this->team = team;
-                    closest = nullptr;
+                    closest.SetZero();
+                    score = 0.0f;
+                    found = false;
                 }
 
                 bool ReportFixture(b2Fixture *fixture) override {
@@ -275,32 +334,32 @@ namespace Fantasy {
                     entt::registry &registry = App::iregistry();
                     if(
                         !registry.valid(e) ||
-                        (!registry.any_of<TeamComp>(e) || registry.get<TeamComp>(e).team == team) ||
+                        !registry.any_of<TeamComp>(e) ||
                         (!registry.any_of<HealthComp>(e) || !registry.get<HealthComp>(e).canHurt())
                     ) return true;
 
-                    float range = (body->GetPosition() - origin).LengthSquared();
-                    if(range > radius) return true;
-
-                    if(closest == nullptr) {
-                        closest = body;
-                        return true;
-                    }
-
-                    entt::entity b = (entt::entity)closest->GetUserData().pointer;
-                    float brange = (closest->GetPosition() - origin).LengthSquared();
-                    
-                    if(priority(b) * (1.0f - brange / radius) < priority(e) * (1.0f - range / radius)) closest = body;
+                    const TeamComp &comp = registry.get<TeamComp>(e);
+                    consider(body->GetPosition(), comp.team, comp.priority);
                     return true;
                 }
 
-                float priority(entt::entity e) {
-                    entt::registry &registry = App::iregistry();
-                    return registry.any_of<TeamComp>(e) ? registry.get<TeamComp>(e).priority : 1.0f;
+                void consider(const b2Vec2 &pos, Team::TeamType team, float priority) {
+                    if(team == this->team) return;
+
+                    float range = (pos - origin).LengthSquared();
+                    if(range > radius) return;
+
+                    float value = priority * (1.0f - range / radius);
+                    if(!found || score < value) {
+                        closest = pos;
+                        score = value;
+                        found = true;
+                    }
                 }
 
-                b2Body *get() {
-                    return closest;
+                bool get(b2Vec2 *pos) {
+                    if(found) *pos = closest;
+                    return found;
                 }
             } report(pos, range, regist.get<TeamComp>(ref).team);
 
@@ -310,28 +369,48 @@ namespace Fantasy {
             bound.upperBound = pos + extent;
 
             world.QueryAABB(&report, bound);
+            App::icontrol().projectiles->query(bound, [&report](const b2Vec2 &pos, Team::TeamType team, float priority) {
+                report.consider(pos, team, priority);
+            });
 
-            b2Body *target = report.get();
-            if(target != nullptr) {
-                if(shootSfx) createSfx(shootSfx);
-                if(!shootFx.empty()) createFx(shootFx, true);
-                entt::entity bullet = App::icontent().getByName<EntityType>(this->bullet)->create();
+            aiming = report.get(&target);
+        }
+    }
 
-                regist.get<TeamComp>(bullet).team = regist.get<TeamComp>(ref).team;
-                regist.get<TemporalComp>(bullet).range = range * 1.4f;
+    void ShooterComp::update() {
+        entt::registry &regist = App::iregistry();
+        if(!aiming) return;
 
-                b2Body *bbody = regist.get<RigidComp>(bullet).body;
-                bbody->SetTransform(pos, glm::orientedAngle(glm::vec2(1.0f, 0.0f), glm::normalize(glm::vec2(target->GetPosition().x - pos.x, target->GetPosition().y - pos.y))));
+        b2Body *body = regist.get<RigidComp>(ref).body;
+        b2Vec2 pos = body->GetPosition();
+        aiming = false;
 
-                b2Vec2 impulse = target->GetPosition() - pos;
-                impulse.Normalize();
-                impulse *= this->impulse;
-                bbody->ApplyLinearImpulseToCenter(impulse, true);
-                body->ApplyLinearImpulseToCenter(-impulse, true);
+        if(shootSfx) createSfx(shootSfx);
+        if(shootFx) createFx(shootFx, true);
 
-                lastShoot = time;
-            }
+        Contents &content = App::icontent();
+        Team::TeamType team = regist.get<TeamComp>(ref).team;
+
+        b2Vec2 impulse = target - pos;
+        impulse.Normalize();
+        impulse *= this->impulse;
+
+        if(bulletType == CType::PROJECTILE) {
+            ProjectileType *type = content.getById<ProjectileType>(this->bullet);
+            App::icontrol().projectiles->create(type, team, pos, (1.0f / type->mass) * impulse, range * 1.4f);
+        } else {
+            entt::entity bullet = content.getById<EntityType>(this->bullet)->create();
+
+            regist.get<TeamComp>(bullet).team = team;
+            regist.get<TemporalComp>(bullet).range = range * 1.4f;
+
+            b2Body *bbody = regist.get<RigidComp>(bullet).body;
+            bbody->SetTransform(pos, glm::orientedAngle(glm::vec2(1.0f, 0.0f), glm::normalize(glm::vec2(target.x - pos.x, target.y - pos.y))));
+            bbody->ApplyLinearImpulseToCenter(impulse, true);
         }
+
+        body->ApplyLinearImpulseToCenter(-impulse, true);
+        lastShoot = timer;
     }
 
     TemporalComp::TemporalComp(entt::entity e, TemporalFlag flags): Component(e) {
@@ -5,10 +5,11 @@
 #include <box2d/box2d.h>
 #include <entt/entity/registry.hpp>
 #include <string>
-#include <optional>
 #include <functional>
 
 #include "team.h"
+#include "content.h"
+#include "snapshot.h"
 #include "../graphics/tex_atlas.h"
 
 namespace Fantasy {
@@ -19,11 +20,13 @@ namespace Fantasy {
         public:
         Component(entt::entity);
 
-        virtual void update();
+        void update();
         void remove();
-        entt::entity createFx(const std::string &, bool follow = false);
-        int createSfx(Mix_Chunk *);
+        entt::entity createFx(ContentID, bool follow = false);
+        int createSfx(SoundID);
         entt::entity getRef();
+
+        static int createSfx(SoundID, const b2Vec2 &);
     };
 
     class RigidComp: public Component {
@@ -31,15 +34,12 @@ namespace Fantasy {
         b2Body *body;
         float rotateSpeed;
 
-        std::string spawnFx, deathFx;
-        Mix_Chunk *spawnSfx, *deathSfx;
-
         private:
         bool spawned;
 
         public:
         RigidComp(entt::entity, b2Body *);
-        void update() override;
+        void update();
 
         void beginCollide(RigidComp &);
         void endCollide(RigidComp &);
@@ -48,27 +48,52 @@ namespace Fantasy {
         static void onDestroy(entt::registry &, entt::entity);
     };
 
-    class DrawComp: public Component {
+    class FxComp: public Component {
         public:
-        std::string drawer;
+        ContentID spawnFx, deathFx;
+        SoundID spawnSfx, deathSfx;
+
+        public:
+        FxComp(entt::entity);
+
+        void spawned();
+        void died();
+    };
 
-        std::optional<TexRegion> region;
+    class DrawComp: public Component {
+        public:
+        ContentID drawer;
+        RegionID region;
         float width, height, z;
+        float spin;
+
+        // Side of the square the drawer may paint into, for drawers that reach past width and height.
+        float clip;
+        // Placement for drawables without a body; bodies take precedence.
+        b2Vec2 pos;
+        float angle;
+        // Never moves or changes, so it's baked once beneath everything dynamic instead of being extracted every tick.
+        // Changing it takes a registry.patch<DrawComp>() to re-bake; hit flashes and health bars aren't drawn.
+        bool retained;
+
+        private:
+        float initTime;
 
         public:
-        DrawComp(entt::entity, const std::string &);
-        DrawComp(entt::entity, const std::string &, float);
-        DrawComp(entt::entity, const std::string &, float, float);
-        DrawComp(entt::entity, const std::string &, float, float, float);
+        DrawComp(entt::entity, ContentID);
+        DrawComp(entt::entity, ContentID, float);
+        DrawComp(entt::entity, ContentID, float, float);
+        DrawComp(entt::entity, ContentID, float, float, float);
 
-        void update() override;
+        void extract(RenderItem &);
+        float rotation();
     };
 
     class JumpComp: public Component {
         public:
         float force, timeout;
-        std::string effect;
-        Mix_Chunk *sound;
+        ContentID effect;
+        SoundID sound;
 
         private:
         bool holding, jumping;
@@ -78,7 +103,7 @@ namespace Fantasy {
         public:
         JumpComp(entt::entity, float, float);
 
-        void update() override;
+        void update();
         void hold();
         void release(float, float);
         bool isHolding();
@@ -99,7 +124,7 @@ namespace Fantasy {
         HealthComp(entt::entity, float, float, float);
 
         public:
-        void update() override;
+        void update();
         void kill();
         void killed();
         void heal(float);
@@ -121,24 +146,29 @@ namespace Fantasy {
 
     class ShooterComp: public Component {
         public:
-        std::string bullet, shootFx;
-        Mix_Chunk *shootSfx;
+        ContentID bullet, shootFx;
+        CType bulletType;
+        SoundID shootSfx;
         float rate, impulse, range, inaccuracy;
 
         private:
+        // Where aim() found a target this tick, be it a body or another team's projectile.
+        b2Vec2 target;
+        bool aiming;
         float lastShoot, timer;
 
         public:
-        ShooterComp(entt::entity, const std::string &, float);
-        ShooterComp(entt::entity, const std::string &, float, float);
-        ShooterComp(entt::entity, const std::string &, float, float, float);
+        ShooterComp(entt::entity, const Content *, float);
+        ShooterComp(entt::entity, const Content *, float, float);
+        ShooterComp(entt::entity, const Content *, float, float, float);
 
-        void update() override;
+        void aim();
+        void update();
     };
 
     class TemporalComp: public Component {
         public:
-        enum TemporalFlag {
+        enum TemporalFlag: unsigned char {
             RANGE = 1,
             TIME = 2
         };
@@ -154,7 +184,7 @@ namespace Fantasy {
         public:
         TemporalComp(entt::entity, TemporalFlag);
 
-        void update() override;
+        void update();
         float rangef();
         float timef();
     };
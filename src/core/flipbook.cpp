@@ -0,0 +1,135 @@
+#include <SDL.h>
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "flipbook.h"
+#include "../app.h"
+#include "../graphics/gl_state.h"
+
+namespace Fantasy {
+    // A flipbook is a stand-in for one drawer; past this it costs more than drawing the drawer live is worth.
+    static constexpr size_t MAX_BYTES = 8 << 20;
+
+    Flipbook::Flipbook(const DrawType *type, float pixels) {
+        if(type->period <= 0.0f || type->frames <= 0 || type->variants <= 0 || type->extent <= 0.0f) {
+            throw std::runtime_error(std::string("Drawer '").append(type->name).append("' doesn't loop."));
+        }
+
+        int count = type->frames * type->variants;
+        cell = (int)ceilf(type->extent * pixels);
+        cols = (int)ceilf(sqrtf((float)count));
+        rows = (count + cols - 1) / cols;
+
+        int max;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
+        if(FrameBuffer::bucket(cols * cell) > max || FrameBuffer::bucket(rows * cell) > max) {
+            throw std::runtime_error(std::string("Flipbook of '").append(type->name).append("' doesn't fit in a ").append(std::to_string(max)).append("px texture."));
+        }
+
+        size_t size = (size_t)FrameBuffer::bucket(cols * cell) * FrameBuffer::bucket(rows * cell) * 4;
+        if(size > MAX_BYTES) {
+            throw std::runtime_error(std::string("Flipbook of '").append(type->name).append("' would take ").append(std::to_string(size >> 20)).append(" MB."));
+        }
+
+        this->type = type;
+        buffer = new FrameBuffer(cols * cell, rows * cell);
+        buffer->setFilter(GL_LINEAR, GL_LINEAR);
+        regions = new std::vector<TexRegion>();
+
+        SpriteBatch &batch = App::ibatch();
+        FrameUniforms &uniforms = App::iuniforms();
+        float half = type->extent / 2.0f;
+
+        // Flipped, so each frame's top lands on its lowest row. The caller's next upload puts its own view back.
+        uniforms.proj(glm::ortho(-half, half, half, -half));
+        uniforms.camera(0.0f, 0.0f);
+        uniforms.upload();
+
+        buffer->begin();
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // Alpha accumulates as coverage instead of being squared, which leaves premultiplied color behind.
+        bool blended = GLState::blended();
+        GLState::blend(true);
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        for(int i = 0; i < count; i++) {
+            int x = (i % cols) * cell, y = (i / cols) * cell;
+            GLState::viewport(x, y, cell, cell);
+
+            RenderItem item;
+            item.entity = (entt::entity)(i / type->frames);
+            item.drawer = type->id;
+            item.region = 0;
+            item.pos.SetZero();
+            item.bound.lowerBound = b2Vec2(-half, -half);
+            item.bound.upperBound = b2Vec2(half, half);
+            item.rotation = 0.0f;
+            item.width = item.height = 1.0f;
+            item.z = 0.0f;
+            item.hit = 0.0f;
+            item.health = -1.0f;
+            item.progress = type->period * (i % type->frames) / type->frames;
+            item.seed = 0.0f;
+
+            batch.col(Color::white);
+            batch.tint(Color());
+            type->drawer(item);
+            batch.flush();
+
+            regions->push_back(TexRegion(buffer->texture, x, y, cell, cell));
+        }
+
+        unpremultiply();
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::blend(blended);
+        buffer->end();
+
+        SDL_Log(
+            "[flipbook] Baked '%s', %d frames of %d variants at %dpx, %zu bytes.",
+            type->name.c_str(), type->frames, type->variants, cell, bytes()
+        );
+    }
+
+    Flipbook::~Flipbook() {
+        delete buffer;
+        delete regions;
+    }
+
+    const TexRegion &Flipbook::frame(const RenderItem &item) {
+        int index = std::min(std::max((int)(item.progress / type->period * type->frames), 0), type->frames - 1);
+        int variant = (unsigned int)item.entity % type->variants;
+
+        return regions->at(variant * type->frames + index);
+    }
+
+    void Flipbook::draw(const RenderItem &item) {
+        // Frames are baked upright at unit size, so the item's own size and rotation go onto the quad.
+        App::ibatch().draw(frame(item), item.pos.x, item.pos.y, type->extent * item.width, type->extent * item.height, item.rotation);
+    }
+
+    size_t Flipbook::bytes() {
+        return (size_t)buffer->allocWidth * buffer->allocHeight * 4;
+    }
+
+    // Sprites blend with straight alpha, so the frames are read back once and divided through.
+    void Flipbook::unpremultiply() {
+        int width = cols * cell, height = rows * cell;
+        std::vector<unsigned char> pixels((size_t)width * height * 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        for(size_t i = 0; i < pixels.size(); i += 4) {
+            unsigned int alpha = pixels[i + 3];
+            if(alpha == 0 || alpha == 255) continue;
+
+            for(size_t c = 0; c < 3; c++) pixels[i + c] = (unsigned char)std::min((pixels[i + c] * 255u + alpha / 2) / alpha, 255u);
+        }
+
+        buffer->texture->bind();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+}
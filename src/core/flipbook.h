@@ -0,0 +1,35 @@
+#ifndef FLIPBOOK_H
+#define FLIPBOOK_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../graphics/frame_buffer.h"
+#include "../graphics/tex_atlas.h"
+#include "content.h"
+#include "snapshot.h"
+
+namespace Fantasy {
+    // A looping drawer rendered once into a grid of frames on an offscreen target, variant after variant, so drawing it
+    // is a single quad of the frame its progress falls on. Frames are stored top row first, like atlas pages.
+    class Flipbook {
+        private:
+        const DrawType *type;
+        FrameBuffer *buffer;
+        std::vector<TexRegion> *regions;
+        int cell, cols, rows;
+
+        public:
+        Flipbook(const DrawType *, float);
+        ~Flipbook();
+
+        const TexRegion &frame(const RenderItem &);
+        void draw(const RenderItem &);
+        size_t bytes();
+
+        private:
+        void unpremultiply();
+    };
+}
+
+#endif
@@ -18,13 +18,51 @@ namespace Fantasy {
     GameController::GameController() {
         regist = new entt::registry();
         regist->on_destroy<RigidComp>().connect<&RigidComp::onDestroy>();
-        removal = new std::unordered_set<entt::entity>();
+        layers = new RenderLayers(*regist);
+
+        // Sized for a full arena: 500 spikes, the leaks, their summons and whatever effects are alive at once. This only
+        // keeps the pools from reallocating while the arena spawns; EnTT still allocates them on the regular heap.
+        size_t expected = 2048;
+        regist->storage<RigidComp>().reserve(expected);
+        regist->storage<DrawComp>().reserve(expected);
+        regist->storage<HealthComp>().reserve(expected);
+        regist->storage<TeamComp>().reserve(expected);
+        regist->storage<ShooterComp>().reserve(expected / 2);
+        regist->storage<TemporalComp>().reserve(expected / 2);
+        regist->storage<FxComp>().reserve(expected);
+        removal = new std::vector<entt::entity>();
+        effects = new std::vector<EffectInstance>();
+        effectSeed = 0;
 
         world = new b2World(b2Vec2(0.0f, -9.81f));
         world->SetContactListener(this);
         world->SetContactFilter(this);
 
         content = new Contents();
+        projectiles = new Projectiles();
+        snapshots = new RenderSnapshots();
+        focus.SetZero();
+
+        // Systems that move or create bodies and entities stay on one chain. Health and aim only touch their own
+        // components and read the rest, so they run beside it; so does extract, beside the last of it. Removals and
+        // effects can come from either side, which is why queueing them takes a lock.
+        systems = new TaskGraph();
+        int physics = systems->add("physics", [this]() {
+            world->Step(1.0f / 60.0f, 1, 1);
+            projectiles->update();
+        });
+
+        int rigid = systems->add("rigid", [this]() { regist->view<RigidComp>().each([](const entt::entity &e, RigidComp &comp) { comp.update(); }); }, {physics});
+        int jump = systems->add("jump", [this]() { regist->view<JumpComp>().each([](const entt::entity &e, JumpComp &comp) { comp.update(); }); }, {rigid});
+        int health = systems->add("health", [this]() { regist->view<HealthComp>().each([](const entt::entity &e, HealthComp &comp) { comp.update(); }); }, {physics});
+        int aim = systems->add("aim", [this]() {
+            auto view = regist->view<ShooterComp>();
+            App::ijobs().parallelEach<ShooterComp>(view, 64, [](const entt::entity &e, ShooterComp &comp) { comp.aim(); });
+        }, {rigid, health});
+
+        int shoot = systems->add("shoot", [this]() { regist->view<ShooterComp>().each([](const entt::entity &e, ShooterComp &comp) { comp.update(); }); }, {aim, jump});
+        systems->add("temporal", [this]() { regist->view<TemporalComp>().each([](const entt::entity &e, TemporalComp &comp) { comp.update(); }); }, {shoot});
+        systems->add("extract", [this]() { extract(); }, {shoot});
 
         leakKilled = 0;
         playing = resetting = false;
@@ -47,6 +85,8 @@ namespace Fantasy {
         App::instance->input->attach(Input::KEYBOARD, [&](InputContext &ctx) {
             switch(ctx.read<SDL_KeyboardEvent>().keysym.scancode) {
                 case SDL_SCANCODE_F11: if(ctx.performed) { App::instance->setFullscreen(!App::instance->isFullscreen()); } break;
+                case SDL_SCANCODE_F3: if(ctx.performed) { logMemory(); } break;
+                case SDL_SCANCODE_F4: if(ctx.performed) { systems->log(); App::irenderer().log(); } break;
                 case SDL_SCANCODE_ESCAPE: if(ctx.performed) {
                     if(exitTime == -1.0f) exitTime = Time::time();
                 } else {
@@ -80,6 +120,11 @@ namespace Fantasy {
     GameController::~GameController() {
         removeEntities();
         delete removal;
+        delete effects;
+        delete systems;
+        delete projectiles;
+        delete snapshots;
+        delete layers;
         delete regist;
         delete world;
         delete content;
@@ -90,6 +135,7 @@ namespace Fantasy {
         regist->each([this](const entt::entity e) { regist->destroy(e); });
         regist->clear();
         removal->clear();
+        projectiles->clear();
 
         for(int i = -1; i <= 1; i += 2) {
             b2BodyDef bodyDef;
@@ -109,7 +155,9 @@ namespace Fantasy {
 
             entt::entity borderA = regist->create();
             regist->emplace<RigidComp>(borderA, borderA, bodyA);
-            regist->emplace<DrawComp>(borderA, borderA, content->genericRegion->name, borderThickness, worldWidth).region = App::iatlas().get("red-box");
+            DrawComp &drawA = regist->emplace<DrawComp>(borderA, borderA, content->genericRegion->id, borderThickness, worldWidth);
+            drawA.region = App::iatlas().find("red-box");
+            drawA.retained = true;
             regist->emplace<HealthComp>(borderA, borderA, -1.0f, 10.0f);
 
             bodyDef.position.Set(i * worldWidth / 2.0f - borderThickness / 2.0f * i, 0.0f);
@@ -120,7 +168,9 @@ namespace Fantasy {
 
             entt::entity borderB = regist->create();
             regist->emplace<RigidComp>(borderB, borderB, bodyB);
-            regist->emplace<DrawComp>(borderB, borderB, content->genericRegion->name, worldHeight, borderThickness).region = App::iatlas().get("red-box");
+            DrawComp &drawB = regist->emplace<DrawComp>(borderB, borderB, content->genericRegion->id, worldHeight, borderThickness);
+            drawB.region = App::iatlas().find("red-box");
+            drawB.retained = true;
             regist->emplace<HealthComp>(borderB, borderB, -1.0f, 10.0f);
         }
 
@@ -150,12 +200,7 @@ namespace Fantasy {
         if((restartTime != -1.0f && Time::time() - restartTime >= 3.0f) || (winTime != -1.0f && Time::time() - winTime >= 5.0f)) resetGame();
         removeEntities();
 
-        world->Step(1.0f / 60.0f, 1, 1);
-        regist->view<RigidComp>().each([](const entt::entity &e, RigidComp &comp) { comp.update(); });
-        regist->view<JumpComp>().each([](const entt::entity &e, JumpComp &comp) { comp.update(); });
-        regist->view<HealthComp>().each([](const entt::entity &e, HealthComp &comp) { comp.update(); });
-        regist->view<ShooterComp>().each([](const entt::entity &e, ShooterComp &comp) { comp.update(); });
-        regist->view<TemporalComp>().each([](const entt::entity &e, TemporalComp &comp) { comp.update(); });
+        systems->run(App::ijobs());
     }
     
     void GameController::BeginContact(b2Contact *contact) {
@@ -195,12 +240,135 @@ namespace Fantasy {
         }
     }
 
-    void GameController::scheduleRemoval(entt::entity e) { removal->insert(e); }
+    void GameController::scheduleRemoval(entt::entity e) {
+        std::lock_guard<std::mutex> guard(removalLock);
+        removal->push_back(e);
+    }
+
+    // Seeds are spaced so every emitter of an effect can offset its own without running into the next effect's.
+    void GameController::spawnEffect(ContentID effect, const b2Vec2 &pos, const b2Vec2 &velocity) {
+        std::lock_guard<std::mutex> guard(effectLock);
+        effects->push_back({effect, pos, velocity, Time::time(), effectSeed});
+        effectSeed += 16;
+    }
     void GameController::removeEntities() {
-        for(entt::entity e : *removal) regist->destroy(e);
+        for(entt::entity e : *removal) {
+            if(!regist->valid(e)) continue;
+
+            // Death effects fire here rather than from a destroy signal, so they still see every component of the entity.
+            FxComp *fx = regist->try_get<FxComp>(e);
+            if(fx != nullptr && !resetting) fx->died();
+
+            regist->destroy(e);
+        }
         removal->clear();
     }
 
+    void GameController::logMemory() {
+        SDL_Log(
+            "[heap] %zu allocs, %zu bytes requested in total, %zu allocs in the last frame.",
+            Memory::allocations(), Memory::allocatedBytes(), App::instance->getFrameAllocs()
+        );
+
+        FrameArena &arena = App::iarena();
+        MemoryStats frame("frame");
+        frame.bytes = frame.peak = arena.used();
+        frame.reserved = arena.capacity();
+        frame.log();
+
+        RenderTargets &targets = *App::irenderer().targets;
+        SDL_Log("[targets] %zu pooled render targets, %zu bytes of storage.", targets.size(), targets.bytes());
+
+#ifdef B2_USER_SETTINGS
+        Memory::box2d().getStats().log();
+#else
+        SDL_Log("[box2d] %d bodies, %d contacts, %d proxies in Box2D's own block allocator.", world->GetBodyCount(), world->GetContactCount(), world->GetProxyCount());
+#endif
+
+        size_t bytes = 0;
+        bytes += logPool<RigidComp>("RigidComp");
+        bytes += logPool<FxComp>("FxComp");
+        bytes += logPool<DrawComp>("DrawComp");
+        bytes += logPool<JumpComp>("JumpComp");
+        bytes += logPool<HealthComp>("HealthComp");
+        bytes += logPool<TeamComp>("TeamComp");
+        bytes += logPool<ShooterComp>("ShooterComp");
+        bytes += logPool<TemporalComp>("TemporalComp");
+        bytes += logPool<IdentifierComp>("IdentifierComp");
+
+        size_t entities = 0;
+        regist->each([&entities](const entt::entity e) { entities++; });
+        if(entities > 0) SDL_Log("[entity] %zu alive, %.1f component bytes each on average.", entities, (float)bytes / (float)entities);
+    }
+
+    template<typename T>
+    size_t GameController::logPool(const char *name) {
+        auto &pool = regist->storage<T>();
+
+        MemoryStats stats(name);
+        stats.allocations = pool.size();
+        stats.bytes = stats.peak = pool.size() * sizeof(T);
+        stats.reserved = pool.capacity() * sizeof(T);
+        SDL_Log("[%s] %zu bytes each, %zu components, %zu of %zu bytes used, %.1f%% unused.", name, sizeof(T), pool.size(), stats.bytes, stats.reserved, stats.fragmentation() * 100.0f);
+
+        return stats.bytes;
+    }
+
+    void GameController::extract() {
+        RenderSnapshot &snap = snapshots->back();
+        snap.clear();
+
+        if(regist->valid(player)) focus = regist->get<RigidComp>(player).body->GetPosition();
+        snap.focus = focus;
+        snap.playing = playing;
+        snap.startTime = startTime;
+        snap.restartTime = restartTime;
+        snap.winTime = winTime;
+        snap.resetTime = resetTime;
+        snap.exitTime = exitTime;
+
+        // Layers only re-sort what changed since the last tick, so the items come out already in draw order.
+        layers->refresh();
+        for(size_t i = 0; i < layers->size(); i++) {
+            RenderLayer layer;
+            layer.z = layers->z(i);
+            layer.begin = snap.items.size();
+
+            for(const SortKey &entry : layers->entries(i)) {
+                snap.items.emplace_back();
+                regist->get<DrawComp>((entt::entity)entry.value).extract(snap.items.back());
+            }
+
+            layer.end = snap.items.size();
+            snap.index(layer);
+            snap.layers.push_back(layer);
+        }
+
+        // Each of the two buffers copies the retained items once per change, not once per tick.
+        if(snap.retainedVersion != layers->retainedVersion()) {
+            snap.retained.clear();
+            for(entt::entity e : layers->retained()) {
+                snap.retained.emplace_back();
+                regist->get<DrawComp>(e).extract(snap.retained.back());
+            }
+
+            std::stable_sort(snap.retained.begin(), snap.retained.end(), [](const RenderItem &a, const RenderItem &b) {
+                return a.z < b.z || (a.z == b.z && (uint32_t)a.entity < (uint32_t)b.entity);
+            });
+
+            snap.retainedVersion = layers->retainedVersion();
+        }
+
+        projectiles->extract(snap.projectiles);
+        {
+            std::lock_guard<std::mutex> guard(effectLock);
+            snap.effects.swap(*effects);
+        }
+        regist->view<IdentifierComp>().each([this, &snap](const entt::entity &e, IdentifierComp &comp) {
+            if(comp.id == "leak" && regist->any_of<RigidComp>(e)) snap.markers.push_back(regist->get<RigidComp>(e).body->GetPosition());
+        });
+    }
+
     bool GameController::isResetting() { return resetting; }
     bool GameController::isPlaying() { return playing; }
     float GameController::getWinTime() { return winTime; }
@@ -208,4 +376,5 @@ namespace Fantasy {
     float GameController::getResetTime() { return resetTime; }
     float GameController::getExitTime() { return exitTime; }
     float GameController::getStartTime() { return startTime; }
+    b2Vec2 GameController::getFocus() { return focus; }
 }
@@ -3,15 +3,27 @@
 
 #include <entt/entity/registry.hpp>
 #include <box2d/box2d.h>
-#include <unordered_set>
+#include <mutex>
+#include <vector>
 
 #include "../app_listener.h"
 #include "content.h"
+#include "projectiles.h"
+#include "snapshot.h"
+#include "render_layers.h"
+#include "../util/jobs.h"
 
 namespace Fantasy {
     class GameController: public AppListener, public b2ContactListener, public b2ContactFilter {
         private:
-        std::unordered_set<entt::entity> *removal;
+        std::vector<entt::entity> *removal;
+        std::mutex removalLock;
+        TaskGraph *systems;
+        RenderLayers *layers;
+        std::vector<EffectInstance> *effects;
+        std::mutex effectLock;
+        unsigned int effectSeed;
+        b2Vec2 focus;
         float restartTime;
         float winTime;
         float resetTime;
@@ -27,6 +39,8 @@ namespace Fantasy {
         static const float borderThickness;
 
         Contents *content;
+        Projectiles *projectiles;
+        RenderSnapshots *snapshots;
         b2World *world;
         entt::registry *regist;
         entt::entity player;
@@ -36,7 +50,9 @@ namespace Fantasy {
         ~GameController() override;
         void update() override;
         void scheduleRemoval(entt::entity);
+        void spawnEffect(ContentID, const b2Vec2 &, const b2Vec2 &);
         void resetGame();
+        void logMemory();
 
         bool isResetting();
         bool isPlaying();
@@ -45,6 +61,7 @@ namespace Fantasy {
         float getResetTime();
         float getExitTime();
         float getStartTime();
+        b2Vec2 getFocus();
 
         void BeginContact(b2Contact *) override;
         void EndContact(b2Contact *) override;
@@ -52,6 +69,8 @@ namespace Fantasy {
 
         private:
         void removeEntities();
+        void extract();
+        template<typename T> size_t logPool(const char *);
     };
 }
 
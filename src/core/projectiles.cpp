@@ -0,0 +1,244 @@
+#include "projectiles.h"
+#include "entity.h"
+#include "time.h"
+#include "../app.h"
+#include "../util/mathf.h"
+
+namespace Fantasy {
+    // Squared distance between segments [p1, q1] and [p2, q2].
+    static float segmentDistance(const b2Vec2 &p1, const b2Vec2 &q1, const b2Vec2 &p2, const b2Vec2 &q2) {
+        b2Vec2 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+        float a = b2Dot(d1, d1), e = b2Dot(d2, d2), f = b2Dot(d2, r);
+        float s = 0.0f, t = 0.0f;
+
+        if(a <= b2_epsilon && e <= b2_epsilon) return r.LengthSquared();
+        if(a <= b2_epsilon) {
+            t = Mathf::clamp(f / e);
+        } else {
+            float c = b2Dot(d1, r);
+            if(e <= b2_epsilon) {
+                s = Mathf::clamp(-c / a);
+            } else {
+                float b = b2Dot(d1, d2), denom = a * e - b * b;
+                if(denom > b2_epsilon) s = Mathf::clamp((b * f - c * e) / denom);
+
+                t = (b * s + f) / e;
+                if(t < 0.0f) {
+                    t = 0.0f;
+                    s = Mathf::clamp(-c / a);
+                } else if(t > 1.0f) {
+                    t = 1.0f;
+                    s = Mathf::clamp((b - c) / a);
+                }
+            }
+        }
+
+        return ((p1 + s * d1) - (p2 + t * d2)).LengthSquared();
+    }
+
+    Projectiles::Projectiles() {
+        maxRadius = 0.0f;
+        castTeam = Team::GENERIC;
+        castFixture = nullptr;
+        castFraction = 1.0f;
+    }
+
+    void Projectiles::create(ProjectileType *type, Team::TeamType team, const b2Vec2 &pos, const b2Vec2 &vel, float range) {
+        types.push_back(type);
+        teams.push_back(team);
+        positions.push_back(pos);
+        velocities.push_back(vel);
+        angles.push_back(atan2f(vel.y, vel.x));
+        spins.push_back(Mathf::random() > 0.5f ? type->spin : -type->spin);
+        initTimes.push_back(Time::time());
+        healths.push_back(type->health);
+        travelled.push_back(0.0f);
+        ranges.push_back(range);
+    }
+
+    void Projectiles::update() {
+        b2World &world = App::iworld();
+        entt::registry &regist = App::iregistry();
+
+        float delta = 1.0f / 60.0f;
+        b2Vec2 gravity = world.GetGravity();
+
+        for(size_t i = 0; i < types.size(); i++) {
+            ProjectileType *type = types[i];
+            b2Vec2 &pos = positions[i];
+            b2Vec2 &vel = velocities[i];
+
+            vel += (delta * type->gravityScale) * gravity;
+            b2Vec2 dir = delta * vel;
+            float len = dir.Normalize();
+            if(len <= b2_epsilon) continue;
+
+            // Elongated shots also sweep both long edges, keeping whichever ray hits first.
+            b2Vec2 reach = (len + type->radius) * dir;
+            b2Vec2 side = type->halfWidth * b2Vec2(-dir.y, dir.x);
+            castTeam = teams[i];
+            castFixture = nullptr;
+            castFraction = 1.0f;
+            world.RayCast(this, pos, pos + reach);
+            if(type->halfWidth > 0.0f) {
+                world.RayCast(this, pos + side, pos + side + reach);
+                world.RayCast(this, pos - side, pos - side + reach);
+            }
+
+            if(castFixture == nullptr) {
+                pos += len * dir;
+                travelled[i] += len;
+            } else {
+                float moved = fmaxf(castFraction * (len + type->radius) - type->radius, 0.0f);
+                travelled[i] += moved;
+                pos += moved * dir;
+
+                b2Body *body = castFixture->GetBody();
+                body->ApplyLinearImpulse(type->mass * vel, castPoint, true);
+
+                float damage = type->damage;
+                entt::entity e = (entt::entity)body->GetUserData().pointer;
+                if(regist.valid(e) && regist.any_of<HealthComp>(e)) {
+                    HealthComp &health = regist.get<HealthComp>(e);
+                    if(type->damage > 0.0f && health.canHurt()) health.hurt(type->damage);
+
+                    damage += health.damage;
+                }
+
+                healths[i] -= damage;
+            }
+        }
+
+        collide();
+
+        // Backwards, so the last projectile swapped into a removed slot has already been looked at.
+        for(size_t i = types.size(); i-- > 0;) {
+            if(healths[i] <= 0.0f || travelled[i] >= ranges[i]) remove(i);
+        }
+
+        sort();
+    }
+
+    void Projectiles::extract(std::vector<ProjectileItem> &items) {
+        float time = Time::time();
+        for(size_t i = 0; i < types.size(); i++) {
+            ProjectileType *type = types[i];
+
+            ProjectileItem item;
+            item.region = &type->getRegion();
+            item.pos = positions[i];
+            item.rotation = angles[i] + spins[i] * (time - initTimes[i]);
+            item.width = type->width;
+            item.height = type->height;
+            item.z = type->z;
+            items.push_back(item);
+        }
+    }
+
+    void Projectiles::clear() {
+        types.clear();
+        teams.clear();
+        positions.clear();
+        velocities.clear();
+        angles.clear();
+        spins.clear();
+        initTimes.clear();
+        healths.clear();
+        travelled.clear();
+        ranges.clear();
+        order.clear();
+        orderX.clear();
+    }
+
+    // Projectiles are capsules along their velocity; ones of different teams that touch hurt each other as bodies would,
+    // each also taking its own damage.
+    void Projectiles::collide() {
+        sort();
+
+        for(size_t k = 0; k < order.size(); k++) {
+            size_t a = order[k];
+            ProjectileType *typeA = types[a];
+
+            for(size_t l = k + 1; l < order.size() && orderX[l] - orderX[k] <= typeA->radius + maxRadius; l++) {
+                size_t b = order[l];
+                ProjectileType *typeB = types[b];
+                if(teams[a] == teams[b]) continue;
+
+                b2Vec2 dirA = velocities[a], dirB = velocities[b];
+                dirA.Normalize();
+                dirB.Normalize();
+
+                float thickA = typeA->halfWidth > 0.0f ? typeA->halfWidth : typeA->radius;
+                float thickB = typeB->halfWidth > 0.0f ? typeB->halfWidth : typeB->radius;
+                b2Vec2 halfA = (typeA->radius - thickA) * dirA, halfB = (typeB->radius - thickB) * dirB;
+
+                const b2Vec2 &posA = positions[a], &posB = positions[b];
+                float dst = segmentDistance(posA - halfA, posA + halfA, posB - halfB, posB + halfB);
+                if(dst > (thickA + thickB) * (thickA + thickB)) continue;
+
+                healths[a] -= typeA->damage + typeB->damage;
+                healths[b] -= typeA->damage + typeB->damage;
+            }
+        }
+    }
+
+    void Projectiles::sort() {
+        order.resize(types.size());
+        for(size_t i = 0; i < order.size(); i++) order[i] = i;
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return positions[a].x < positions[b].x; });
+
+        orderX.resize(order.size());
+        maxRadius = 0.0f;
+        for(size_t k = 0; k < order.size(); k++) {
+            orderX[k] = positions[order[k]].x;
+            maxRadius = fmaxf(maxRadius, types[order[k]]->radius);
+        }
+    }
+
+    size_t Projectiles::size() {
+        return types.size();
+    }
+
+    float Projectiles::ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) {
+        if(fixture->IsSensor()) return -1.0f;
+
+        entt::registry &regist = App::iregistry();
+        entt::entity e = (entt::entity)fixture->GetBody()->GetUserData().pointer;
+        if(!regist.valid(e) || (regist.any_of<TeamComp>(e) && regist.get<TeamComp>(e).team == castTeam)) return -1.0f;
+
+        // Later casts of the same projectile only count if they hit sooner.
+        if(fraction >= castFraction && castFixture != nullptr) return castFraction;
+
+        castFixture = fixture;
+        castPoint = point;
+        castFraction = fraction;
+        return fraction;
+    }
+
+    void Projectiles::remove(size_t index) {
+        ProjectileType *type = types[index];
+        const b2Vec2 &pos = positions[index];
+
+        if(!App::icontrol().isResetting()) {
+            if(type->deathFx) App::icontent().getById<EffectType>(type->deathFx)->at(pos);
+
+            if(type->deathSfx) Component::createSfx(type->deathSfx, pos);
+        }
+
+        auto erase = [index](auto &array) {
+            array[index] = array.back();
+            array.pop_back();
+        };
+
+        erase(types);
+        erase(teams);
+        erase(positions);
+        erase(velocities);
+        erase(angles);
+        erase(spins);
+        erase(initTimes);
+        erase(healths);
+        erase(travelled);
+        erase(ranges);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef PROJECTILES_H
+#define PROJECTILES_H
+
+#include <box2d/box2d.h>
+#include <algorithm>
+#include <vector>
+
+#include "content.h"
+#include "snapshot.h"
+#include "team.h"
+
+namespace Fantasy {
+    class Projectiles: public b2RayCastCallback {
+        private:
+        std::vector<ProjectileType *> types;
+        std::vector<Team::TeamType> teams;
+        std::vector<b2Vec2> positions;
+        std::vector<b2Vec2> velocities;
+        std::vector<float> angles;
+        std::vector<float> spins;
+        std::vector<float> initTimes;
+        std::vector<float> healths;
+        std::vector<float> travelled;
+        std::vector<float> ranges;
+
+        // Indices sorted by x, for sweeping projectiles against each other and for targeting queries.
+        std::vector<size_t> order;
+        std::vector<float> orderX;
+        float maxRadius;
+
+        Team::TeamType castTeam;
+        b2Fixture *castFixture;
+        b2Vec2 castPoint;
+        float castFraction;
+
+        public:
+        Projectiles();
+
+        void create(ProjectileType *, Team::TeamType, const b2Vec2 &, const b2Vec2 &, float);
+        void update();
+        void extract(std::vector<ProjectileItem> &);
+        void clear();
+        size_t size();
+
+        float ReportFixture(b2Fixture *, const b2Vec2 &, const b2Vec2 &, float) override;
+
+        // Calls `func(pos, team, priority)` for every projectile in the box as of the last update.
+        template<typename F>
+        void query(const b2AABB &bound, F &&func) {
+            size_t begin = std::lower_bound(orderX.begin(), orderX.end(), bound.lowerBound.x) - orderX.begin();
+            for(size_t k = begin; k < order.size() && orderX[k] <= bound.upperBound.x; k++) {
+                size_t i = order[k];
+                const b2Vec2 &pos = positions[i];
+                if(pos.y >= bound.lowerBound.y && pos.y <= bound.upperBound.y) func(pos, teams[i], types[i]->priority);
+            }
+        }
+
+        private:
+        void collide();
+        void sort();
+        void remove(size_t);
+    };
+}
+
+#endif
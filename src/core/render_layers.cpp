@@ -0,0 +1,158 @@
+#include "render_layers.h"
+#include "entity.h"
+#include "../app.h"
+#include "../util/mathf.h"
+
+namespace Fantasy {
+    RenderLayers::RenderLayers(entt::registry &registry) {
+        this->registry = &registry;
+        layers = new std::vector<Layer *>();
+        placed = new std::unordered_map<entt::entity, Layer *>();
+        pending = new std::unordered_set<entt::entity>();
+        retainedSet = new std::unordered_set<entt::entity>();
+        scratch = new std::vector<SortKey>();
+        version = 0;
+
+        registry.on_construct<DrawComp>().connect<&RenderLayers::onChange>(this);
+        registry.on_update<DrawComp>().connect<&RenderLayers::onChange>(this);
+        registry.on_destroy<DrawComp>().connect<&RenderLayers::onDestroy>(this);
+    }
+
+    RenderLayers::~RenderLayers() {
+        registry->on_construct<DrawComp>().disconnect<&RenderLayers::onChange>(this);
+        registry->on_update<DrawComp>().disconnect<&RenderLayers::onChange>(this);
+        registry->on_destroy<DrawComp>().disconnect<&RenderLayers::onDestroy>(this);
+
+        for(Layer *layer : *layers) delete layer;
+        delete layers;
+        delete placed;
+        delete pending;
+        delete retainedSet;
+        delete scratch;
+    }
+
+    void RenderLayers::refresh() {
+        if(pending->empty()) return;
+
+        TexAtlas &atlas = App::iatlas();
+        for(entt::entity e : *pending) {
+            DrawComp &comp = registry->get<DrawComp>(e);
+            auto it = placed->find(e);
+
+            if(comp.retained) {
+                if(it != placed->end()) {
+                    it->second->dirty = true;
+                    placed->erase(it);
+                }
+
+                retainedSet->insert(e);
+                version++;
+                continue;
+            } else if(retainedSet->erase(e)) {
+                version++;
+            }
+
+            Layer *layer = layerAt(comp.z);
+            if(it == placed->end()) {
+                placed->emplace(e, layer);
+            } else {
+                it->second->dirty = true;
+                it->second = layer;
+            }
+
+            // Page, then drawer, then the 20 bit entity index; the index keeps the order stable between ticks.
+            uint64_t page = (uint64_t)atlas.get(comp.region).layer & 0xff;
+            uint64_t drawer = comp.drawer & 0xfff;
+            uint64_t index = (uint32_t)e & 0xfffff;
+
+            layer->added.push_back({page << 32 | drawer << 20 | index, (uint32_t)e});
+            layer->dirty = true;
+        }
+
+        for(size_t i = 0; i < layers->size();) {
+            Layer *layer = layers->at(i);
+            if(!layer->dirty) {
+                i++;
+                continue;
+            }
+
+            // Drop whatever left this layer or is being re-added with a fresh key, then merge in the additions.
+            std::vector<SortKey> &entries = layer->entries;
+            size_t kept = 0;
+            for(const SortKey &entry : entries) {
+                entt::entity e = (entt::entity)entry.value;
+
+                auto it = placed->find(e);
+                if(it != placed->end() && it->second == layer && !pending->count(e)) entries[kept++] = entry;
+            }
+
+            entries.resize(kept);
+            entries.insert(entries.end(), layer->added.begin(), layer->added.end());
+            layer->added.clear();
+            layer->dirty = false;
+
+            if(entries.empty()) {
+                delete layer;
+                layers->erase(layers->begin() + i);
+                continue;
+            }
+
+            scratch->resize(entries.size());
+            Sort::radix(entries.data(), scratch->data(), entries.size());
+            i++;
+        }
+
+        pending->clear();
+    }
+
+    size_t RenderLayers::size() {
+        return layers->size();
+    }
+
+    float RenderLayers::z(size_t index) {
+        return layers->at(index)->z;
+    }
+
+    const std::vector<SortKey> &RenderLayers::entries(size_t index) {
+        return layers->at(index)->entries;
+    }
+
+    const std::unordered_set<entt::entity> &RenderLayers::retained() {
+        return *retainedSet;
+    }
+
+    unsigned int RenderLayers::retainedVersion() {
+        return version;
+    }
+
+    RenderLayers::Layer *RenderLayers::layerAt(float z) {
+        size_t i = 0;
+        for(; i < layers->size(); i++) {
+            Layer *layer = layers->at(i);
+            if(Mathf::near(layer->z, z)) return layer;
+            if(layer->z > z) break;
+        }
+
+        Layer *layer = new Layer();
+        layer->z = z;
+        layer->dirty = false;
+        layers->insert(layers->begin() + i, layer);
+
+        return layer;
+    }
+
+    void RenderLayers::onChange(entt::registry &registry, entt::entity e) {
+        pending->insert(e);
+    }
+
+    void RenderLayers::onDestroy(entt::registry &registry, entt::entity e) {
+        pending->erase(e);
+        if(retainedSet->erase(e)) version++;
+
+        auto it = placed->find(e);
+        if(it != placed->end()) {
+            it->second->dirty = true;
+            placed->erase(it);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef RENDER_LAYERS_H
+#define RENDER_LAYERS_H
+
+#include <entt/entity/registry.hpp>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../util/sort.h"
+
+namespace Fantasy {
+    // Drawables grouped by z in ascending layers, kept in draw order across ticks. Registry signals only queue
+    // changes; refresh() applies them, so z can still be assigned right after emplacing a DrawComp. Later z changes
+    // have to go through registry.patch<DrawComp>() to be picked up. Retained drawables are kept out of the layers
+    // in their own set, which only bumps its version when it changes.
+    class RenderLayers {
+        private:
+        struct Layer {
+            float z;
+            bool dirty;
+            std::vector<SortKey> entries;
+            std::vector<SortKey> added;
+        };
+
+        entt::registry *registry;
+        std::vector<Layer *> *layers;
+        std::unordered_map<entt::entity, Layer *> *placed;
+        std::unordered_set<entt::entity> *pending;
+        std::unordered_set<entt::entity> *retainedSet;
+        std::vector<SortKey> *scratch;
+        unsigned int version;
+
+        public:
+        RenderLayers(entt::registry &);
+        ~RenderLayers();
+
+        void refresh();
+        size_t size();
+        float z(size_t);
+        const std::vector<SortKey> &entries(size_t);
+        const std::unordered_set<entt::entity> &retained();
+        unsigned int retainedVersion();
+
+        private:
+        Layer *layerAt(float);
+        void onChange(entt::registry &, entt::entity);
+        void onDestroy(entt::registry &, entt::entity);
+    };
+}
+
+#endif
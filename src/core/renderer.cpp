@@ -1,4 +1,6 @@
 #include <SDL.h>
+#include <algorithm>
+#include <stdexcept>
 #include <glm/gtx/vector_angle.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -11,45 +13,6 @@
 #include "../app.h"
 #include "../util/mathf.h"
 
-static constexpr const char *BLOOM_VERTEX_SHADER = R"(
-#version 150 core
-in vec2 a_position;
-in vec2 a_tex_coords_0;
-
-out vec2 v_tex_coords;
-
-void main() {
-    gl_Position = vec4(a_position, 1.0, 1.0);
-    v_tex_coords = a_tex_coords_0;
-})";
-
-static constexpr const char *BLOOM_FRAGMENT_SHADER = R"(
-#version 150 core
-out vec4 fragColor;
-in vec2 v_tex_coords;
-
-uniform sampler2D u_texture;
-uniform vec2 u_resolution;
-uniform int u_range;
-uniform float u_suppress;
-
-void main() {
-    float range2 = pow(u_range, 2.0);
-    vec2 step = vec2(1.0) / u_resolution;
-
-    vec4 sum = vec4(0.0);
-    for(int x = -u_range; x <= u_range; x++) {
-        for(int y = -u_range; y <= u_range; y++) {
-            float distance = x * x + y * y;
-            if(distance > range2) continue;
-
-            sum += texture2D(u_texture, v_tex_coords + vec2(x * step.x, y * step.y));
-        }
-    }
-
-    fragColor = texture2D(u_texture, v_tex_coords) + sum / pow(2 * u_range + 1, 2) / u_suppress;
-})";
-
 static constexpr const char *PARALLAX_VERTEX_SHADER = R"(
 #version 150 core
 in vec2 a_position;
@@ -58,8 +21,13 @@ in vec2 a_tex_coords_0;
 out vec2 v_tex_coords_1;
 out vec2 v_tex_coords_2;
 
-uniform vec2 u_resolution;
-uniform vec2 u_position;
+layout(std140) uniform Frame {
+    mat4 u_proj;
+    vec2 u_resolution;
+    vec2 u_camera;
+    vec2 u_zoom;
+    float u_time;
+};
 
 uniform vec2 u_dimension_1;
 uniform float u_intensity_1;
@@ -68,13 +36,16 @@ uniform float u_intensity_2;
 
 void main() {
     gl_Position = vec4(a_position, 1.0, 1.0);
-    vec2 pos = vec2(u_position.x, -u_position.y);
+    vec2 pos = vec2(u_camera.x, -u_camera.y);
+    vec2 view = u_resolution / u_zoom;
 
-    vec2 scale_1 = u_resolution / u_dimension_1;
-    v_tex_coords_1 = a_tex_coords_0 * scale_1 - (0.5 * scale_1) + (pos * u_intensity_1) / (u_dimension_1 * 2.0);
+    vec2 dimension_1 = u_dimension_1 / u_zoom;
+    vec2 scale_1 = view / dimension_1;
+    v_tex_coords_1 = a_tex_coords_0 * scale_1 - (0.5 * scale_1) + (pos * u_intensity_1) / (dimension_1 * 2.0);
 
-    vec2 scale_2 = u_resolution / u_dimension_2;
-    v_tex_coords_2 = a_tex_coords_0 * scale_2 - (0.5 * scale_2) + (pos * u_intensity_2) / (u_dimension_2 * 2.0);
+    vec2 dimension_2 = u_dimension_2 / u_zoom;
+    vec2 scale_2 = view / dimension_2;
+    v_tex_coords_2 = a_tex_coords_0 * scale_2 - (0.5 * scale_2) + (pos * u_intensity_2) / (dimension_2 * 2.0);
 })";
 
 static constexpr const char *PARALLAX_FRAGMENT_SHADER = R"(
@@ -94,16 +65,33 @@ void main() {
 })";
 
 namespace Fantasy {
-    Renderer::Renderer() {
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    thread_local SpriteBatch *Renderer::recording = nullptr;
+
+    Renderer::Renderer(bool instanced, bool compact, Bloom::Quality bloomQuality) {
+        GLState::blend(true);
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
         atlas = new TexAtlas("assets/sprites/texture.atlas");
-        batch = new SpriteBatch();
-        buffer = new FrameBuffer(App::instance->getWidth(), App::instance->getHeight());
-        toRender = new std::vector<entt::entity>();
+        if(instanced && !InstanceBatch::supported()) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Instanced sprites need OpenGL 3.3, using the vertex batch instead.");
+            instanced = false;
+        }
+
+        if(instanced && compact) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "The compact layout is for the vertex batch, ignoring it.");
+            compact = false;
+        }
+
+        batch = instanced ? (SpriteBatch *)new InstanceBatch() : new SpriteBatch(32768, nullptr, compact);
+        SDL_Log(
+            "Drawing sprites with the %s batch, %zu bytes per sprite.",
+            instanced ? "instanced" : compact ? "compact vertex" : "vertex", batch->format().size * sizeof(float)
+        );
+        uniforms = new FrameUniforms();
+        targets = new RenderTargets();
+        lastRendered = 0;
+        lists = new std::vector<DrawList *>();
 
-        bloom = new Shader(BLOOM_VERTEX_SHADER, BLOOM_FRAGMENT_SHADER);
         quad = new Mesh(4, 6, 2, new VertexAttr[2]{VertexAttr::position2D, VertexAttr::texCoords});
         float quadvert[] = {
             -1.0f, -1.0f, 0.0f, 0.0f,
@@ -115,6 +103,8 @@ namespace Fantasy {
         quad->setVertices(quadvert, 0, sizeof(quadvert) / sizeof(float));
         quad->setIndices(indices, 0, sizeof(indices) / sizeof(unsigned short));
 
+        bloom = new Bloom(quad, bloomQuality);
+
         parallax = new Shader(PARALLAX_VERTEX_SHADER, PARALLAX_FRAGMENT_SHADER);
         background = new Mesh(4, 6, 2, new VertexAttr[2]{VertexAttr::position2D, VertexAttr::texCoords});
         float backvert[] = {
@@ -138,36 +128,63 @@ namespace Fantasy {
         backTex1 = bgLoad("assets/background/background-1.png");
         backTex2 = bgLoad("assets/background/background-2.png");
 
+        // Everything the background needs per frame comes from the frame block; these never change.
+        parallax->bind();
+        glUniform1i(parallax->uniform(Uniform::TEXTURE_1), 0);
+        glUniform1i(parallax->uniform(Uniform::TEXTURE_2), 1);
+        glUniform2f(parallax->uniform(Uniform::DIMENSION_1), backTex1->width * 4.0f, backTex1->height * 4.0f);
+        glUniform1f(parallax->uniform(Uniform::INTENSITY_1), 0.27f);
+        glUniform2f(parallax->uniform(Uniform::DIMENSION_2), backTex2->width * 4.0f, backTex2->height * 4.0f);
+        glUniform1f(parallax->uniform(Uniform::INTENSITY_2), 0.1f);
+
         pos = glm::dvec2(0.0, 0.0);
         scl = glm::dvec2(48.0, 48.0);
         proj = glm::identity<glm::dmat4>();
         flipProj = glm::identity<glm::fmat4>();
+        frame = nullptr;
+        frameStats = {0, 0, 0, 0};
+        glStats = {0, 0};
+
+        retained = new RetainedLayer();
+        effects = new EffectLayer(App::icontent(), atlas->get("white"));
+        flipbooks = new std::vector<Flipbook *>();
+        graph = new RenderGraph(targets);
+        int scene = graph->target("scene", 0, true);
+        backgroundPass = graph->add("background", {}, scene, true, [this]() { drawBackground(); });
+        retainedPass = graph->add("retained", {}, scene, true, [this]() { drawRetained(); });
+        worldPass = graph->add("world", {}, scene, true, [this]() { drawEntities(*frame); });
+        graph->add("overlay", {}, scene, true, [this]() { drawOverlay(*frame); });
+        bloom->setup(*graph, scene, RenderGraph::BACKBUFFER);
     }
 
     Renderer::~Renderer() {
+        for(DrawList *list : *lists) delete list;
+        delete lists;
         delete atlas;
         delete batch;
-        delete buffer;
-        delete quad;
+        delete graph;
+        delete retained;
+        delete effects;
+        for(Flipbook *book : *flipbooks) delete book;
+        delete flipbooks;
         delete bloom;
+        delete targets;
+        delete quad;
         delete background;
         delete parallax;
         delete backTex1;
         delete backTex2;
-        delete toRender;
+        delete uniforms;
     }
 
     void Renderer::update() {
-        float time = Time::time();
-        GameController &control = App::icontrol();
-        b2World &world = *control.world;
-        entt::registry &regist = *control.regist;
-        entt::entity player = control.player;
-
-        if(regist.valid(player)) {
-            b2Vec2 pos = regist.get<RigidComp>(player).body->GetTransform().p;
-            this->pos = glm::vec2(pos.x, pos.y);
-        }
+        frameStats = Mesh::stats;
+        glStats = GLState::stats;
+        Mesh::resetStats();
+        GLState::resetStats();
+
+        const RenderSnapshot &snap = App::icontrol().snapshots->front();
+        pos = glm::dvec2(snap.focus.x, snap.focus.y);
 
         int rw = App::instance->getWidth(), rh = App::instance->getHeight();
         float w = rw / scl.x, h = rh / scl.y;
@@ -180,82 +197,63 @@ namespace Fantasy {
             pos.y + h, pos.y - h
         );
 
-        glViewport(0, 0, rw, rh);
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        buffer->resize(rw, rh);
-        buffer->begin();
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        GLState::window(rw, rh);
+        if(flipbooks->empty()) bake();
 
-        if(control.isPlaying()) {
-            drawEntities();
-        } else {
-            TexRegion regions[] = {atlas->get("splash-inst-1"), atlas->get("splash-inst-2"), atlas->get("splash-inst-3"), atlas->get("splash-inst-4"), atlas->get("splash-inst-5")};
-            float totalHeight = regions[0].height / 2.0f;
-            for(int i = 0; i < 5; i++) totalHeight += regions[i].height / 6.0f;
+        batch->proj(proj);
+        uniforms->resolution(rw, rh);
+        uniforms->camera(pos.x, pos.y);
+        uniforms->zoom(scl.x, scl.y);
+        uniforms->time(Time::time());
+        uniforms->upload();
+        frame = &snap;
+        retained->update(snap);
+        effects->update(snap);
+
+        graph->setEnabled(backgroundPass, snap.playing);
+        graph->setEnabled(retainedPass, snap.playing && !retained->empty());
+        graph->setEnabled(worldPass, snap.playing);
+        graph->execute(rw, rh);
+        targets->endFrame();
+    }
 
-            float height = 0.0f;
-            for(int i = 0; i < 5; i++) {
-                const TexRegion &region = regions[i];
+    // Needs the app to reach this renderer, so it waits for the first frame rather than running in the constructor.
+    void Renderer::bake() {
+        std::vector<Content *> *types = App::icontent().indexBy(CType::DRAW);
+        flipbooks->resize(types->size(), nullptr);
 
-                float prog = Mathf::clamp((Time::time() - (control.getStartTime() + 0.2f * i + 0.5f)) / 1.5f);
-                batch->col(Color(1.0f, 1.0f, 1.0f, 0.0f).lerp(Color::white, prog));
-                batch->draw(region,
-                    0.0f, totalHeight / 2.0f + height - (1.0f - powf(1.0f - prog, 3.0f) * 1.5f),
-                    region.width / 6.0f, region.height / 6.0f
-                );
+        for(size_t i = 1; i < types->size(); i++) {
+            DrawType *type = (DrawType *)types->at(i);
+            if(type->period <= 0.0f || type->frames <= 0) continue;
 
-                height -= region.height / 3.0f;
+            // The atlas' own 8 pixels per unit, so baked drawers are as sharp as everything else.
+            try {
+                flipbooks->at(i) = new Flipbook(type, 8.0f);
+            } catch(const std::runtime_error &e) {
+                SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "[flipbook] %s Drawing it live instead.", e.what());
             }
-
-            batch->col(Color::white);
         }
+    }
 
-        if(control.getExitTime() != -1.0f) {
-            const TexRegion &region = atlas->get("splash-quit");
-            batch->col(Color(1.0f, 1.0f, 1.0f, Mathf::clamp((Time::time() - control.getExitTime()) / 1.0f)));
-
-            glm::dvec2 spos;
-            unproject(0.0, 0.0, &spos.x, &spos.y);
-            batch->draw(region, spos.x, spos.y, spos.x, spos.y - region.height / 8.0f, region.width / 8.0f, region.height / 8.0f);
-            batch->col(Color::white);
-        }
-
-        batch->proj(proj);
-        batch->flush();
-        buffer->end();
-
-        bloom->bind();
-        glUniform1i(bloom->uniformLoc("u_texture"), buffer->texture->active(0));
-        glUniform2f(bloom->uniformLoc("u_resolution"), App::instance->getWidth() / 2.5f, App::instance->getHeight() / 2.5f);
-        glUniform1i(bloom->uniformLoc("u_range"), 4);
-        glUniform1f(bloom->uniformLoc("u_suppress"), 1.2f);
+    void Renderer::drawBackground() {
+        parallax->bind();
+        backTex1->active(0);
+        backTex2->active(1);
 
-        quad->render(bloom, GL_TRIANGLES, 0, quad->maxIndices);
+        background->render(parallax, GL_TRIANGLES, 0, background->maxIndices);
     }
 
-    void Renderer::drawEntities() {
-        b2World &world = App::iworld();
-        entt::registry &regist = App::iregistry();
-        GameController &control = App::icontrol();
-
+    void Renderer::drawRetained() {
         float w = App::instance->getWidth() / scl.x, h = App::instance->getHeight() / scl.y;
 
-        parallax->bind();
-        glUniform2f(parallax->uniformLoc("u_resolution"), w, h);
-        glUniform2f(parallax->uniformLoc("u_position"), pos.x, pos.y);
-
-        float bgScaleX = scl.x / 4.0f, bgScaleY = scl.y / 4.0f;
-        glUniform1i(parallax->uniformLoc("u_texture_1"), backTex1->active(0));
-        glUniform2f(parallax->uniformLoc("u_dimension_1"), backTex1->width / bgScaleX, backTex1->height / bgScaleY);
-        glUniform1f(parallax->uniformLoc("u_intensity_1"), 0.27f);
-        glUniform1i(parallax->uniformLoc("u_texture_2"), backTex2->active(1));
-        glUniform2f(parallax->uniformLoc("u_dimension_2"), backTex2->width / bgScaleX, backTex2->height / bgScaleY);
-        glUniform1f(parallax->uniformLoc("u_intensity_2"), 0.1f);
+        b2AABB bound;
+        bound.lowerBound = b2Vec2(pos.x - w, pos.y - h);
+        bound.upperBound = b2Vec2(pos.x + w, pos.y + h);
+        retained->draw(bound);
+    }
 
-        background->render(parallax, GL_TRIANGLES, 0, background->maxIndices);
+    void Renderer::drawEntities(const RenderSnapshot &snap) {
+        float w = App::instance->getWidth() / scl.x, h = App::instance->getHeight() / scl.y;
 
         batch->col(Color::white);
         batch->tint(Color());
@@ -264,49 +262,84 @@ namespace Fantasy {
         bound.lowerBound = b2Vec2(pos.x - w, pos.y - h);
         bound.upperBound = b2Vec2(pos.x + w, pos.y + h);
 
-        world.QueryAABB(this, bound);
-        std::sort(toRender->begin(), toRender->end(), [](const entt::entity &a, const entt::entity &b) {
-            entt::registry &registry = App::iregistry();
-            float za = registry.get<DrawComp>(a).z, zb = registry.get<DrawComp>(b).z;
+        FrameVector<const RenderItem *> toRender(App::iarena());
+        toRender.reserve(lastRendered);
 
-            if(Mathf::near(za, zb)) {
-                return (int)a < (int)b;
-            } else {
-                return za < zb;
+        // Layers come in z order with their items in draw order, so culling is all that's left to do.
+        for(const RenderLayer &layer : snap.layers) {
+            if(layer.cols == 0) {
+                for(size_t i = layer.begin; i < layer.end; i++) {
+                    if(b2TestOverlap(snap.items[i].bound, bound)) toRender.push_back(&snap.items[i]);
+                }
+
+                continue;
             }
-            });
 
-        for(const entt::entity &e : *toRender) {
-            batch->col(Color::white);
-            batch->tint(Color());
-            regist.get<DrawComp>(e).update();
+            int x0 = std::max((int)floorf(bound.lowerBound.x / layer.cellSize) - layer.originX, 0);
+            int y0 = std::max((int)floorf(bound.lowerBound.y / layer.cellSize) - layer.originY, 0);
+            int x1 = std::min((int)floorf(bound.upperBound.x / layer.cellSize) - layer.originX, layer.cols - 1);
+            int y1 = std::min((int)floorf(bound.upperBound.y / layer.cellSize) - layer.originY, layer.rows - 1);
+            if(x0 > x1 || y0 > y1) continue;
+
+            // Items spanning several cells are seen more than once; marking them keeps one entry each, and sweeping
+            // the marks afterwards brings back the layer's order without sorting.
+            size_t count = layer.end - layer.begin;
+            FrameVector<uint64_t> visible((count + 63) / 64, 0, App::iarena());
+            const unsigned int *offsets = snap.cells.data() + layer.cellStart;
+
+            for(int y = y0; y <= y1; y++) {
+                for(int x = x0; x <= x1; x++) {
+                    int cell = y * layer.cols + x;
+                    for(unsigned int k = offsets[cell]; k < offsets[cell + 1]; k++) {
+                        size_t i = snap.cellItems[k] - layer.begin;
+                        uint64_t bit = (uint64_t)1 << (i % 64);
+
+                        if(!(visible[i / 64] & bit) && b2TestOverlap(snap.items[layer.begin + i].bound, bound)) visible[i / 64] |= bit;
+                    }
+                }
+            }
 
-            if(regist.any_of<HealthComp>(e)) {
-                HealthComp &comp = regist.get<HealthComp>(e);
-                if(!comp.showBar || !comp.canHurt()) continue;
+            for(size_t word = 0; word < visible.size(); word++) {
+                uint64_t bits = visible[word];
+                for(size_t i = word * 64; bits != 0; i++, bits >>= 1) {
+                    if(bits & 1) toRender.push_back(&snap.items[layer.begin + i]);
+                }
+            }
+        }
 
-                b2Vec2 pos = regist.get<RigidComp>(e).body->GetPosition();
+        // Contiguous runs of the z-sorted list are recorded on the job threads, then appended in order on this one.
+        Jobs &jobs = App::ijobs();
+        size_t count = toRender.size();
+        size_t chunks = std::min((size_t)jobs.threadCount() + 1, (count + 255) / 256);
 
-                float frac = comp.health / comp.maxHealth;
-                const TexRegion &region = atlas->get("white");
+        if(chunks <= 1) {
+            drawItems(snap, bound, toRender.data(), count, -INFINITY);
+        } else {
+            while(lists->size() < chunks) lists->push_back(new DrawList(batch->format()));
 
-                batch->tint(Color::red);
-                batch->draw(region, pos.x, pos.y - 1.0f, pos.x - 0.625f, pos.y - 1.075, 1.25f, 0.125f);
-                batch->tint(Color::green);
+            jobs.parallelFor(chunks, 1, [&](size_t from, size_t to) {
+                for(size_t chunk = from; chunk < to; chunk++) {
+                    size_t begin = count * chunk / chunks, end = count * (chunk + 1) / chunks;
 
-                float bw = (int)((1.25f * frac) / 0.125f) * 0.125f;
-                batch->draw(region, pos.x, pos.y - 1.0f, pos.x - 0.625f, pos.y - 1.075f, bw, 0.125f);
-            }
+                    DrawList *list = lists->at(chunk);
+                    list->clear();
 
-            batch->col(Color::white);
-            batch->tint(Color());
+                    recording = list;
+                    drawItems(snap, bound, toRender.data() + begin, end - begin, begin == 0 ? -INFINITY : toRender[begin - 1]->z);
+                    recording = nullptr;
+                }
+            });
+
+            for(size_t chunk = 0; chunk < chunks; chunk++) lists->at(chunk)->submit(*batch);
         }
 
-        regist.view<IdentifierComp>().each([this](const entt::entity &e, IdentifierComp &comp) {
-            entt::registry &registry = App::iregistry();
-            if(comp.id != "leak" || !registry.any_of<RigidComp>(e)) return;
+        drawProjectiles(snap, bound, count == 0 ? -INFINITY : toRender[count - 1]->z, INFINITY);
+
+        // Every parametric effect sits above every other drawable, so they go in one piece after the sorted items.
+        batch->flush();
+        effects->draw();
 
-            b2Vec2 target = registry.get<RigidComp>(e).body->GetPosition();
+        for(const b2Vec2 &target : snap.markers) {
             b2Vec2 pos = b2Vec2(this->pos.x, this->pos.y);
 
             b2Vec2 result = target - pos;
@@ -318,31 +351,126 @@ namespace Fantasy {
             batch->col(Color::red);
             batch->draw(atlas->get("white"), pos.x + result.x, pos.y + result.y, 0.5f, 0.125f, angle);
             batch->col(Color::white);
-        });
-
-        if(control.getRestartTime() != -1.0f) {
-            const TexRegion &region = atlas->get("splash-lose");
-            batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
-        } else if(control.getWinTime() != -1.0f) {
-            const TexRegion &region = atlas->get("splash-win");
-            batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
+        }
+
+        batch->flush();
+        lastRendered = toRender.size();
+    }
+
+    void Renderer::drawOverlay(const RenderSnapshot &snap) {
+        if(snap.playing) {
+            if(snap.restartTime != -1.0f) {
+                const TexRegion &region = atlas->get("splash-lose");
+                batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
+            } else if(snap.winTime != -1.0f) {
+                const TexRegion &region = atlas->get("splash-win");
+                batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
+            } else {
+                const TexRegion &region = atlas->get("splash-intro");
+                batch->col(Color(1.0f, 1.0f, 1.0f, 1.0f - Mathf::clamp((Time::time() - (snap.resetTime + 2.5f)) / 0.5f)));
+                batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
+                batch->col(Color::white);
+            }
         } else {
-            const TexRegion &region = atlas->get("splash-intro");
-            batch->col(Color(1.0f, 1.0f, 1.0f, 1.0f - Mathf::clamp((Time::time() - (control.getResetTime() + 2.5f)) / 0.5f)));
-            batch->draw(region, pos.x, pos.y - 5.0f, region.width / 8.0f, region.height / 8.0f);
+            TexRegion regions[] = {atlas->get("splash-inst-1"), atlas->get("splash-inst-2"), atlas->get("splash-inst-3"), atlas->get("splash-inst-4"), atlas->get("splash-inst-5")};
+            float totalHeight = regions[0].height / 2.0f;
+            for(int i = 0; i < 5; i++) totalHeight += regions[i].height / 6.0f;
+
+            float height = 0.0f;
+            for(int i = 0; i < 5; i++) {
+                const TexRegion &region = regions[i];
+
+                float prog = Mathf::clamp((Time::time() - (snap.startTime + 0.2f * i + 0.5f)) / 1.5f);
+                batch->col(Color(1.0f, 1.0f, 1.0f, 0.0f).lerp(Color::white, prog));
+                batch->draw(region,
+                    0.0f, totalHeight / 2.0f + height - (1.0f - powf(1.0f - prog, 3.0f) * 1.5f),
+                    region.width / 6.0f, region.height / 6.0f
+                );
+
+                height -= region.height / 3.0f;
+            }
+
+            batch->col(Color::white);
+        }
+
+        if(snap.exitTime != -1.0f) {
+            const TexRegion &region = atlas->get("splash-quit");
+            batch->col(Color(1.0f, 1.0f, 1.0f, Mathf::clamp((Time::time() - snap.exitTime) / 1.0f)));
+
+            glm::dvec2 spos;
+            unproject(0.0, 0.0, &spos.x, &spos.y);
+            batch->draw(region, spos.x, spos.y, spos.x, spos.y - region.height / 8.0f, region.width / 8.0f, region.height / 8.0f);
             batch->col(Color::white);
         }
 
-        toRender->clear();
+        batch->flush();
     }
 
-    bool Renderer::ReportFixture(b2Fixture *fixture) {
-        entt::registry &registry = App::iregistry();
+    void Renderer::drawItems(const RenderSnapshot &snap, const b2AABB &bound, const RenderItem *const *items, size_t count, float lastZ) {
+        SpriteBatch &batch = App::ibatch();
+        Contents &content = App::icontent();
+        const TexRegion &white = atlas->get("white");
 
-        entt::entity e = (entt::entity)fixture->GetBody()->GetUserData().pointer;
-        if(registry.valid(e) && registry.any_of<DrawComp>(e)) toRender->push_back(e);
+        for(size_t i = 0; i < count; i++) {
+            const RenderItem *item = items[i];
+            if(item->z > lastZ) {
+                drawProjectiles(snap, bound, lastZ, item->z);
+                lastZ = item->z;
+            }
 
-        return true;
+            batch.col(Color::white);
+            batch.tint(Color(0.8f, 0.0f, 0.1f, item->hit));
+            Flipbook *book = flipbooks->at(item->drawer);
+            if(book != nullptr) {
+                book->draw(*item);
+            } else {
+                content.getById<DrawType>(item->drawer)->drawer(*item);
+            }
+            batch.tint(Color());
+
+            if(item->health >= 0.0f) {
+                const b2Vec2 &pos = item->pos;
+
+                batch.tint(Color::red);
+                batch.draw(white, pos.x, pos.y - 1.0f, pos.x - 0.625f, pos.y - 1.075, 1.25f, 0.125f);
+                batch.tint(Color::green);
+
+                float bw = (int)((1.25f * item->health) / 0.125f) * 0.125f;
+                batch.draw(white, pos.x, pos.y - 1.0f, pos.x - 0.625f, pos.y - 1.075f, bw, 0.125f);
+            }
+
+            batch.col(Color::white);
+            batch.tint(Color());
+        }
+    }
+
+    void Renderer::drawProjectiles(const RenderSnapshot &snap, const b2AABB &bound, float minZ, float maxZ) {
+        SpriteBatch &batch = App::ibatch();
+        batch.col(Color::white);
+        batch.tint(Color());
+        for(const ProjectileItem &item : snap.projectiles) {
+            if(item.z < minZ || item.z >= maxZ) continue;
+
+            const b2Vec2 &pos = item.pos;
+            float extent = fmaxf(item.width, item.height);
+            if(
+                pos.x + extent < bound.lowerBound.x || pos.x - extent > bound.upperBound.x ||
+                pos.y + extent < bound.lowerBound.y || pos.y - extent > bound.upperBound.y
+            ) continue;
+
+            batch.draw(*item.region, pos.x, pos.y, item.width, item.height, item.rotation - glm::radians(90.0f));
+        }
+    }
+
+    void Renderer::log() {
+        graph->log();
+        SDL_Log(
+            "[mesh] %zu draws, %zu vertex array binds, %zu attribute re-points, %zu GL calls elided last frame.",
+            frameStats.draws, frameStats.arrayBinds, frameStats.repoints, frameStats.elided
+        );
+        SDL_Log("[gl] %zu state changes issued, %zu redundant ones elided last frame.", glStats.issued, glStats.elided);
+        retained->log();
+        effects->log();
     }
 
     void Renderer::unproject(double x, double y, double *newX, double *newY) {
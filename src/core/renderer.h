@@ -7,39 +7,68 @@
 
 #include "../app_listener.h"
 #include "../graphics/sprite_batch.h"
+#include "../graphics/draw_list.h"
+#include "../graphics/instance_batch.h"
 #include "../graphics/tex_atlas.h"
-#include "../graphics/frame_buffer.h"
+#include "../graphics/render_targets.h"
+#include "../graphics/render_graph.h"
+#include "../graphics/bloom.h"
 #include "../graphics/shader.h"
+#include "../graphics/frame_uniforms.h"
+#include "../graphics/gl_state.h"
+#include "../util/memory.h"
+#include "snapshot.h"
+#include "retained_layer.h"
+#include "effect_layer.h"
+#include "flipbook.h"
 
 namespace Fantasy {
-    class Renderer: public AppListener, public b2QueryCallback {
+    class Renderer: public AppListener {
         public:
+        static thread_local SpriteBatch *recording;
+
         TexAtlas *atlas;
         SpriteBatch *batch;
         glm::dmat4 proj;
         glm::dmat4 flipProj;
         glm::dvec2 pos;
         glm::dvec2 scl;
+        RenderTargets *targets;
+        FrameUniforms *uniforms;
 
         private:
-        std::vector<entt::entity> *toRender;
-        FrameBuffer *buffer;
+        size_t lastRendered;
+        std::vector<DrawList *> *lists;
+        RenderGraph *graph;
+        int backgroundPass, retainedPass, worldPass;
+        RetainedLayer *retained;
+        EffectLayer *effects;
+        std::vector<Flipbook *> *flipbooks;
+        const RenderSnapshot *frame;
+        MeshStats frameStats;
+        GLStats glStats;
         Mesh *quad;
-        Shader *bloom;
+        Bloom *bloom;
         Mesh *background;
         Shader *parallax;
         Tex2D *backTex1, *backTex2;
 
         public:
-        Renderer();
+        Renderer(bool, bool, Bloom::Quality);
         ~Renderer() override;
 
         void update() override;
         void unproject(double, double, double *, double *);
-        bool ReportFixture(b2Fixture *fixture) override;
+        void log();
 
         private:
-        void drawEntities();
+        void bake();
+        void drawBackground();
+        void drawRetained();
+        void drawEntities(const RenderSnapshot &);
+        void drawOverlay(const RenderSnapshot &);
+        void drawItems(const RenderSnapshot &, const b2AABB &, const RenderItem *const *, size_t, float);
+        void drawProjectiles(const RenderSnapshot &, const b2AABB &, float, float);
     };
 }
 
@@ -0,0 +1,134 @@
+#include <SDL.h>
+#include <GL/glew.h>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+#include "retained_layer.h"
+#include "renderer.h"
+#include "../app.h"
+
+namespace Fantasy {
+    const float RetainedLayer::chunkSize = 16.0f;
+
+    RetainedLayer::RetainedLayer() {
+        version = 0;
+        items = 0;
+        drawn = 0;
+
+        mesh = nullptr;
+        shader = SpriteBatch::createShader(false);
+        arrayShader = SpriteBatch::createShader(true);
+        list = new DrawList(SpriteBatch::vertexFormat());
+        vertices = new std::vector<float>();
+        ranges = new std::vector<Range>();
+        chunks = new std::vector<Chunk>();
+    }
+
+    RetainedLayer::~RetainedLayer() {
+        if(mesh != nullptr) delete mesh;
+        delete shader;
+        delete arrayShader;
+        delete list;
+        delete vertices;
+        delete ranges;
+        delete chunks;
+    }
+
+    void RetainedLayer::update(const RenderSnapshot &snap) {
+        if(snap.retainedVersion == version) return;
+
+        build(snap);
+        version = snap.retainedVersion;
+    }
+
+    void RetainedLayer::build(const RenderSnapshot &snap) {
+        vertices->clear();
+        ranges->clear();
+        chunks->clear();
+        items = snap.retained.size();
+
+        // Ordered by z first, so chunks keep the layering; items within one keep the snapshot's order.
+        std::map<std::tuple<float, int, int>, std::vector<const RenderItem *>> groups;
+        for(const RenderItem &item : snap.retained) {
+            b2Vec2 center = item.bound.GetCenter();
+            groups[std::make_tuple(item.z, (int)floorf(center.x / chunkSize), (int)floorf(center.y / chunkSize))].push_back(&item);
+        }
+
+        Contents &content = App::icontent();
+        size_t spriteSize = SpriteBatch::vertexFormat().size;
+
+        for(auto &group : groups) {
+            list->clear();
+            list->col(Color::white);
+            list->tint(Color());
+
+            Renderer::recording = list;
+            for(const RenderItem *item : group.second) content.getById<DrawType>(item->drawer)->drawer(*item);
+            Renderer::recording = nullptr;
+
+            Chunk chunk;
+            chunk.bound = group.second.front()->bound;
+            for(const RenderItem *item : group.second) chunk.bound.Combine(item->bound);
+
+            chunk.begin = ranges->size();
+            size_t base = vertices->size() / spriteSize;
+            for(const DrawList::Segment &segment : list->parts()) {
+                ranges->push_back({segment.texture, base + segment.offset / spriteSize, segment.length / spriteSize});
+            }
+
+            chunk.end = ranges->size();
+            vertices->insert(vertices->end(), list->vertices().begin(), list->vertices().end());
+            if(chunk.end > chunk.begin) chunks->push_back(chunk);
+        }
+
+        if(mesh != nullptr) delete mesh;
+        mesh = SpriteBatch::createMesh(vertices->size() / spriteSize, false);
+        if(mesh != nullptr) mesh->setVertices(vertices->data(), 0, vertices->size());
+
+        SDL_Log("[retained] Rebuilt %zu items into %zu chunks.", items, chunks->size());
+    }
+
+    void RetainedLayer::draw(const b2AABB &bound) {
+        drawn = 0;
+        if(mesh == nullptr) return;
+
+        App::iuniforms().upload();
+
+        // Neighbouring visible chunks often continue the same texture, so their ranges are drawn as one.
+        Range pending = {nullptr, 0, 0};
+        auto submit = [this, &pending]() {
+            if(pending.count == 0) return;
+
+            Shader *program = pending.texture->layered() ? arrayShader : shader;
+            program->bind();
+            pending.texture->active(0);
+            mesh->render(program, GL_TRIANGLES, pending.first * 6, pending.count * 6);
+        };
+
+        for(const Chunk &chunk : *chunks) {
+            if(!b2TestOverlap(chunk.bound, bound)) continue;
+
+            drawn++;
+            for(size_t i = chunk.begin; i < chunk.end; i++) {
+                const Range &range = ranges->at(i);
+                if(range.texture == pending.texture && range.first == pending.first + pending.count) {
+                    pending.count += range.count;
+                } else {
+                    submit();
+                    pending = range;
+                }
+            }
+        }
+
+        submit();
+    }
+
+    bool RetainedLayer::empty() {
+        return chunks->empty();
+    }
+
+    void RetainedLayer::log() {
+        SDL_Log("[retained] %zu items in %zu chunks, %zu drawn last frame.", items, chunks->size(), drawn);
+    }
+}
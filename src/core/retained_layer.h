@@ -0,0 +1,55 @@
+#ifndef RETAINED_LAYER_H
+#define RETAINED_LAYER_H
+
+#include <box2d/box2d.h>
+#include <vector>
+
+#include "../graphics/draw_list.h"
+#include "../graphics/mesh.h"
+#include "../graphics/shader.h"
+#include "snapshot.h"
+
+namespace Fantasy {
+    // The snapshot's retained items, recorded once per change into a static mesh instead of being streamed every frame.
+    // Sprites are grouped into chunks by z and position so the view still culls them; each chunk is a few draw ranges.
+    class RetainedLayer {
+        private:
+        struct Range {
+            Tex2D *texture;
+            size_t first, count;
+        };
+
+        struct Chunk {
+            b2AABB bound;
+            size_t begin, end;
+        };
+
+        unsigned int version;
+        size_t items;
+        size_t drawn;
+
+        Mesh *mesh;
+        Shader *shader;
+        Shader *arrayShader;
+        DrawList *list;
+        std::vector<float> *vertices;
+        std::vector<Range> *ranges;
+        std::vector<Chunk> *chunks;
+
+        public:
+        static const float chunkSize;
+
+        RetainedLayer();
+        ~RetainedLayer();
+
+        void update(const RenderSnapshot &);
+        void draw(const b2AABB &);
+        bool empty();
+        void log();
+
+        private:
+        void build(const RenderSnapshot &);
+    };
+}
+
+#endif
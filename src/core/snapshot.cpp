@@ -0,0 +1,106 @@
+#include <math.h>
+
+#include "snapshot.h"
+
+namespace Fantasy {
+    const size_t RenderSnapshot::gridMinItems = 64;
+    const float RenderSnapshot::gridCellSize = 8.0f;
+    const size_t RenderSnapshot::gridMaxCells = 16384;
+
+    RenderSnapshot::RenderSnapshot() {
+        focus.SetZero();
+        playing = false;
+        retainedVersion = 0;
+        startTime = restartTime = winTime = resetTime = exitTime = -1.0f;
+    }
+
+    void RenderSnapshot::clear() {
+        items.clear();
+        layers.clear();
+        cells.clear();
+        cellItems.clear();
+        projectiles.clear();
+        markers.clear();
+        effects.clear();
+    }
+
+    void RenderSnapshot::index(RenderLayer &layer) {
+        layer.cols = layer.rows = 0;
+        layer.cellStart = cells.size();
+        if(layer.end - layer.begin < gridMinItems) return;
+
+        b2AABB extent = items[layer.begin].bound;
+        for(size_t i = layer.begin + 1; i < layer.end; i++) extent.Combine(items[i].bound);
+
+        // Cells grow until the grid fits, so a few stray far-away items can't blow up its size.
+        float size = gridCellSize;
+        int x0, y0, x1, y1;
+        while(true) {
+            x0 = (int)floorf(extent.lowerBound.x / size);
+            y0 = (int)floorf(extent.lowerBound.y / size);
+            x1 = (int)floorf(extent.upperBound.x / size);
+            y1 = (int)floorf(extent.upperBound.y / size);
+
+            if((size_t)(x1 - x0 + 1) * (size_t)(y1 - y0 + 1) <= gridMaxCells) break;
+            size *= 2.0f;
+        }
+
+        layer.originX = x0;
+        layer.originY = y0;
+        layer.cols = x1 - x0 + 1;
+        layer.rows = y1 - y0 + 1;
+        layer.cellSize = size;
+
+        // Count per cell, turn the counts into cell ends, then fill backwards so each end walks down to its cell's start.
+        size_t cellCount = layer.cols * layer.rows, first = cellItems.size();
+        cells.resize(layer.cellStart + cellCount + 1, 0);
+        unsigned int *offsets = cells.data() + layer.cellStart;
+
+        auto span = [&](const b2AABB &bound, int &cx0, int &cy0, int &cx1, int &cy1) {
+            cx0 = (int)floorf(bound.lowerBound.x / size) - x0;
+            cy0 = (int)floorf(bound.lowerBound.y / size) - y0;
+            cx1 = (int)floorf(bound.upperBound.x / size) - x0;
+            cy1 = (int)floorf(bound.upperBound.y / size) - y0;
+        };
+
+        for(size_t i = layer.begin; i < layer.end; i++) {
+            int cx0, cy0, cx1, cy1;
+            span(items[i].bound, cx0, cy0, cx1, cy1);
+
+            for(int y = cy0; y <= cy1; y++) {
+                for(int x = cx0; x <= cx1; x++) offsets[y * layer.cols + x]++;
+            }
+        }
+
+        offsets[0] += first;
+        for(size_t c = 1; c < cellCount; c++) offsets[c] += offsets[c - 1];
+
+        size_t total = offsets[cellCount - 1];
+        offsets[cellCount] = total;
+        cellItems.resize(total);
+
+        for(size_t i = layer.end; i-- > layer.begin;) {
+            int cx0, cy0, cx1, cy1;
+            span(items[i].bound, cx0, cy0, cx1, cy1);
+
+            for(int y = cy0; y <= cy1; y++) {
+                for(int x = cx0; x <= cx1; x++) cellItems[--offsets[y * layer.cols + x]] = i;
+            }
+        }
+    }
+
+    RenderSnapshots::RenderSnapshots() {
+        buffers[0] = new RenderSnapshot();
+        buffers[1] = new RenderSnapshot();
+        current = 0;
+    }
+
+    RenderSnapshots::~RenderSnapshots() {
+        delete buffers[0];
+        delete buffers[1];
+    }
+
+    RenderSnapshot &RenderSnapshots::back() { return *buffers[1 - current]; }
+    const RenderSnapshot &RenderSnapshots::front() { return *buffers[current]; }
+    void RenderSnapshots::swap() { current = 1 - current; }
+}
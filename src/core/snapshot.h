@@ -0,0 +1,95 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <box2d/box2d.h>
+#include <entt/entity/registry.hpp>
+#include <vector>
+
+#include "content.h"
+#include "../graphics/tex_atlas.h"
+
+namespace Fantasy {
+    struct RenderItem {
+        public:
+        entt::entity entity;
+        ContentID drawer;
+        RegionID region;
+        b2Vec2 pos;
+        b2AABB bound;
+        float rotation, width, height, z;
+        float hit, health, progress, seed;
+    };
+
+    struct ProjectileItem {
+        public:
+        const TexRegion *region;
+        b2Vec2 pos;
+        float rotation, width, height, z;
+    };
+
+    // A parametric effect as spawned; the renderer keeps it until its lifetime is up.
+    struct EffectInstance {
+        public:
+        ContentID effect;
+        b2Vec2 pos, velocity;
+        float time;
+        unsigned int seed;
+    };
+
+    // A run of items sharing one z, already in draw order. Large layers also get a uniform grid over their bounds;
+    // cell c lists its items in cellItems[cells[cellStart + c], cells[cellStart + c + 1]).
+    struct RenderLayer {
+        public:
+        float z;
+        size_t begin, end;
+
+        int originX, originY, cols, rows;
+        float cellSize;
+        size_t cellStart;
+    };
+
+    struct RenderSnapshot {
+        public:
+        static const size_t gridMinItems;
+        static const float gridCellSize;
+        static const size_t gridMaxCells;
+
+        std::vector<RenderItem> items;
+        std::vector<RenderLayer> layers;
+        std::vector<unsigned int> cells;
+        std::vector<unsigned int> cellItems;
+        std::vector<ProjectileItem> projectiles;
+        std::vector<b2Vec2> markers;
+        // Only what spawned this tick; every snapshot is rendered exactly once.
+        std::vector<EffectInstance> effects;
+
+        // Not cleared between ticks; only replaced when the version moves.
+        std::vector<RenderItem> retained;
+        unsigned int retainedVersion;
+
+        b2Vec2 focus;
+        bool playing;
+        float startTime, restartTime, winTime, resetTime, exitTime;
+
+        public:
+        RenderSnapshot();
+        void clear();
+        void index(RenderLayer &);
+    };
+
+    class RenderSnapshots {
+        private:
+        RenderSnapshot *buffers[2];
+        int current;
+
+        public:
+        RenderSnapshots();
+        ~RenderSnapshots();
+
+        RenderSnapshot &back();
+        const RenderSnapshot &front();
+        void swap();
+    };
+}
+
+#endif
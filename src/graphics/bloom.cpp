@@ -0,0 +1,210 @@
+#include <SDL.h>
+#include <cstring>
+#include <vector>
+#include <GL/glew.h>
+
+#include "bloom.h"
+
+static constexpr const char *BLOOM_VERTEX_SHADER = R"(
+#version 150 core
+in vec2 a_position;
+in vec2 a_tex_coords_0;
+
+out vec2 v_tex_coords;
+
+void main() {
+    gl_Position = vec4(a_position, 1.0, 1.0);
+    v_tex_coords = a_tex_coords_0;
+})";
+
+// Sources are pooled targets that may be larger than their contents, so taps are scaled into and clamped to the used
+// part; linear filtering would otherwise blend in whatever an earlier borrower left past the edge.
+static constexpr const char *BRIGHT_FRAGMENT_SHADER = R"(
+#version 150 core
+out vec4 fragColor;
+in vec2 v_tex_coords;
+
+uniform sampler2D u_texture;
+uniform vec2 u_texel;
+uniform vec2 u_scale;
+uniform float u_threshold;
+
+vec4 tap(vec2 uv) {
+    return texture(u_texture, clamp(uv, u_texel * 0.5, u_scale - u_texel * 0.5));
+}
+
+void main() {
+    vec2 uv = v_tex_coords * u_scale;
+    vec2 half_texel = u_texel * 0.5;
+    vec4 color = (
+        tap(uv - half_texel) +
+        tap(uv + half_texel) +
+        tap(uv + vec2(half_texel.x, -half_texel.y)) +
+        tap(uv - vec2(half_texel.x, -half_texel.y))
+    ) * 0.25;
+
+    float bright = max(color.r, max(color.g, color.b));
+    fragColor = vec4(color.rgb * (max(bright - u_threshold, 0.0) / max(bright, 0.0001)), 1.0);
+})";
+
+static constexpr const char *DOWN_FRAGMENT_SHADER = R"(
+#version 150 core
+out vec4 fragColor;
+in vec2 v_tex_coords;
+
+uniform sampler2D u_texture;
+uniform vec2 u_texel;
+uniform vec2 u_scale;
+
+vec4 tap(vec2 uv) {
+    return texture(u_texture, clamp(uv, u_texel * 0.5, u_scale - u_texel * 0.5));
+}
+
+void main() {
+    vec2 uv = v_tex_coords * u_scale;
+    vec2 half_texel = u_texel * 0.5;
+    vec4 sum = tap(uv) * 4.0;
+    sum += tap(uv - half_texel);
+    sum += tap(uv + half_texel);
+    sum += tap(uv + vec2(half_texel.x, -half_texel.y));
+    sum += tap(uv - vec2(half_texel.x, -half_texel.y));
+
+    fragColor = sum / 8.0;
+})";
+
+static constexpr const char *UP_FRAGMENT_SHADER = R"(
+#version 150 core
+out vec4 fragColor;
+in vec2 v_tex_coords;
+
+uniform sampler2D u_texture;
+uniform vec2 u_texel;
+uniform vec2 u_scale;
+
+vec4 tap(vec2 uv) {
+    return texture(u_texture, clamp(uv, u_texel * 0.5, u_scale - u_texel * 0.5));
+}
+
+void main() {
+    vec2 uv = v_tex_coords * u_scale;
+    vec2 half_texel = u_texel * 0.5;
+    vec4 sum = tap(uv + vec2(-half_texel.x * 2.0, 0.0));
+    sum += tap(uv + vec2(-half_texel.x, half_texel.y)) * 2.0;
+    sum += tap(uv + vec2(0.0, half_texel.y * 2.0));
+    sum += tap(uv + vec2(half_texel.x, half_texel.y)) * 2.0;
+    sum += tap(uv + vec2(half_texel.x * 2.0, 0.0));
+    sum += tap(uv + vec2(half_texel.x, -half_texel.y)) * 2.0;
+    sum += tap(uv + vec2(0.0, -half_texel.y * 2.0));
+    sum += tap(uv + vec2(-half_texel.x, -half_texel.y)) * 2.0;
+
+    fragColor = sum / 12.0;
+})";
+
+static constexpr const char *COMPOSITE_FRAGMENT_SHADER = R"(
+#version 150 core
+out vec4 fragColor;
+in vec2 v_tex_coords;
+
+uniform sampler2D u_texture;
+uniform sampler2D u_bloom;
+uniform vec2 u_scale;
+uniform vec2 u_bloom_scale;
+uniform float u_intensity;
+
+void main() {
+    fragColor = texture(u_texture, v_tex_coords * u_scale) + texture(u_bloom, v_tex_coords * u_bloom_scale) * u_intensity;
+})";
+
+namespace Fantasy {
+    Bloom::Bloom(Mesh *quad, Quality quality) {
+        this->quad = quad;
+        this->quality = quality;
+        threshold = 0.0f;
+        intensity = 0.5f;
+
+        bright = new Shader(BLOOM_VERTEX_SHADER, BRIGHT_FRAGMENT_SHADER);
+        down = new Shader(BLOOM_VERTEX_SHADER, DOWN_FRAGMENT_SHADER);
+        up = new Shader(BLOOM_VERTEX_SHADER, UP_FRAGMENT_SHADER);
+        composite = new Shader(BLOOM_VERTEX_SHADER, COMPOSITE_FRAGMENT_SHADER);
+
+        for(Shader *shader : {bright, down, up, composite}) {
+            shader->bind();
+            glUniform1i(shader->uniform(Uniform::TEXTURE), 0);
+        }
+
+        glUniform1i(composite->uniform(Uniform::BLOOM), 1);
+    }
+
+    Bloom::~Bloom() {
+        delete bright;
+        delete down;
+        delete up;
+        delete composite;
+    }
+
+    Bloom::Quality Bloom::getQuality() {
+        return quality;
+    }
+
+    // Adds the bright, blur and composite passes reading `scene` and compositing into `output`. With bloom off the
+    // composite is all that remains.
+    void Bloom::setup(RenderGraph &graph, int scene, int output) {
+        std::vector<int> chain;
+        for(int i = 0; i < levels(); i++) chain.push_back(graph.target("bloom", i + 1));
+
+        if(!chain.empty()) {
+            graph.add("bloom-bright", {scene}, chain.front(), false, [this, &graph, scene]() {
+                bright->bind();
+                glUniform1f(bright->uniform(Uniform::THRESHOLD), threshold);
+                pass(bright, graph.get(scene));
+            });
+
+            for(size_t i = 1; i < chain.size(); i++) {
+                int source = chain[i - 1];
+                graph.add("bloom-down", {source}, chain[i], false, [this, &graph, source]() { pass(down, graph.get(source)); });
+            }
+
+            for(size_t i = chain.size() - 1; i > 0; i--) {
+                int source = chain[i];
+                graph.add("bloom-up", {source}, chain[i - 1], false, [this, &graph, source]() { pass(up, graph.get(source)); });
+            }
+        }
+
+        int result = chain.empty() ? scene : chain.front();
+        graph.add("composite", {scene, result}, output, false, [this, &graph, scene, result]() {
+            FrameBuffer *source = graph.get(scene), *lit = graph.get(result);
+
+            composite->bind();
+            source->texture->active(0);
+            lit->texture->active(1);
+            glUniform2f(composite->uniform(Uniform::SCALE), source->scaleX(), source->scaleY());
+            glUniform2f(composite->uniform(Uniform::BLOOM_SCALE), lit->scaleX(), lit->scaleY());
+            glUniform1f(composite->uniform(Uniform::INTENSITY), lit == source ? 0.0f : intensity);
+            quad->render(composite, GL_TRIANGLES, 0, quad->maxIndices);
+        });
+    }
+
+    Bloom::Quality Bloom::parse(const char *name) {
+        if(std::strcmp(name, "off") == 0) return OFF;
+        if(std::strcmp(name, "low") == 0) return LOW;
+        if(std::strcmp(name, "high") == 0) return HIGH;
+        return MEDIUM;
+    }
+
+    int Bloom::levels() {
+        switch(quality) {
+            case LOW: return 2;
+            case MEDIUM: return 3;
+            case HIGH: return 4;
+            default: return 0;
+        }
+    }
+
+    void Bloom::pass(Shader *shader, FrameBuffer *source) {
+        shader->bind();
+        source->texture->active(0);
+        glUniform2f(shader->uniform(Uniform::TEXEL), 1.0f / source->allocWidth, 1.0f / source->allocHeight);
+        glUniform2f(shader->uniform(Uniform::SCALE), source->scaleX(), source->scaleY());
+        quad->render(shader, GL_TRIANGLES, 0, quad->maxIndices);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include "frame_buffer.h"
+#include "render_graph.h"
+#include "mesh.h"
+#include "shader.h"
+
+namespace Fantasy {
+    // Bright pass into half resolution, dual-Kawase blur down and back up a small pyramid, then a composite over the
+    // scene. Each quality step adds one level, so the radius doubles while the cost only grows by a quarter.
+    class Bloom {
+        public:
+        enum Quality {
+            OFF,
+            LOW,
+            MEDIUM,
+            HIGH
+        };
+
+        float threshold, intensity;
+
+        private:
+        Quality quality;
+        Mesh *quad;
+        Shader *bright, *down, *up, *composite;
+
+        public:
+        Bloom(Mesh *, Quality);
+        ~Bloom();
+
+        Quality getQuality();
+        void setup(RenderGraph &, int, int);
+
+        static Quality parse(const char *);
+
+        private:
+        int levels();
+        void pass(Shader *, FrameBuffer *);
+    };
+}
+
+#endif
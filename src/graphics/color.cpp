@@ -40,15 +40,6 @@ namespace Fantasy {
         return *this;
     }
 
-    float Color::fabgr() const {
-        int bits = abgr();
-        return *(float *)&bits;
-    }
-
-    Color &Color::fromFagbr(float abgr) {
-        return fromAbgr(*(unsigned int *)&abgr);
-    }
-
     Color &Color::lerp(const Color &to, float progress) {
         r = Mathf::lerp(r, to.r, progress);
         g = Mathf::lerp(g, to.g, progress);
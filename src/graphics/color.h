@@ -29,8 +29,6 @@ namespace Fantasy {
 
         unsigned int abgr() const;
         Color &fromAbgr(unsigned int);
-        float fabgr() const;
-        Color &fromFagbr(float);
         Color &lerp(const Color &, float);
     };
 }
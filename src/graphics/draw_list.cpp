@@ -0,0 +1,46 @@
+#include "draw_list.h"
+
+namespace Fantasy {
+    DrawList::DrawList(const SpriteFormat &format): SpriteBatch(format, 0, nullptr, nullptr, nullptr) {
+        data = new std::vector<float>();
+        segments = new std::vector<Segment>();
+    }
+
+    DrawList::~DrawList() {
+        delete data;
+        delete segments;
+    }
+
+    void DrawList::flush() {}
+
+    float *DrawList::reserve(Tex2D *texture, size_t &count) {
+        if(segments->empty() || segments->back().texture != texture) segments->push_back({texture, data->size(), 0});
+
+        size_t offset = data->size(), length = count * spriteSize;
+        data->resize(offset + length);
+        segments->back().length += length;
+
+        return data->data() + offset;
+    }
+
+    void DrawList::submit(SpriteBatch &batch) {
+        for(const Segment &segment : *segments) batch.draw(segment.texture, data->data(), segment.offset, segment.length);
+    }
+
+    void DrawList::clear() {
+        data->clear();
+        segments->clear();
+    }
+
+    size_t DrawList::size() {
+        return data->size() / spriteSize;
+    }
+
+    const std::vector<float> &DrawList::vertices() {
+        return *data;
+    }
+
+    const std::vector<DrawList::Segment> &DrawList::parts() {
+        return *segments;
+    }
+}
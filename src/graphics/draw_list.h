@@ -0,0 +1,37 @@
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+#include <vector>
+
+#include "sprite_batch.h"
+
+namespace Fantasy {
+    class DrawList: public SpriteBatch {
+        public:
+        struct Segment {
+            Tex2D *texture;
+            size_t offset, length;
+        };
+
+        private:
+        std::vector<float> *data;
+        std::vector<Segment> *segments;
+
+        public:
+        DrawList(const SpriteFormat &);
+        ~DrawList() override;
+
+        void flush() override;
+
+        void submit(SpriteBatch &);
+        void clear();
+        size_t size();
+        const std::vector<float> &vertices();
+        const std::vector<Segment> &parts();
+
+        protected:
+        float *reserve(Tex2D *, size_t &) override;
+    };
+}
+
+#endif
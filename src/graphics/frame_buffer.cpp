@@ -2,7 +2,7 @@
 #include <GL/glew.h>
 
 #include "frame_buffer.h"
-#include "../app.h"
+#include "gl_state.h"
 
 namespace Fantasy {
     FrameBuffer *FrameBuffer::last = nullptr;
@@ -16,46 +16,41 @@ namespace Fantasy {
 
         this->width = width;
         this->height = height;
+        allocWidth = bucket(width);
+        allocHeight = bucket(height);
         hasColor = color;
         hasDepth = depth;
         hasStencil = stencil;
         before = nullptr;
         capturing = false;
 
+        texture = nullptr;
+        render = 0;
+
         glGenFramebuffers(1, &data);
         begin();
 
         if(color) {
-            texture = new Tex2D(width, height, nullptr);
-            texture->load();
-            texture->setFilter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
-            texture->setWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
-
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->data, 0);
-        } else {
-            texture = nullptr;
+            texture = new Tex2D(allocWidth, allocHeight, nullptr);
+            glGenTextures(1, &texture->data);
         }
 
-        if(depth || stencil) {
-            glGenRenderbuffers(1, &render);
-            glBindRenderbuffer(GL_RENDERBUFFER, render);
+        if(depth || stencil) glGenRenderbuffers(1, &render);
+        allocate();
 
-            glRenderbufferStorage(
-                GL_RENDERBUFFER,
-                (depth && stencil) ? GL_DEPTH24_STENCIL8 :
-                depth ? GL_DEPTH_COMPONENT24 : GL_STENCIL_INDEX8,
-                width, height
-            );
+        if(color) {
+            texture->setFilter(GL_NEAREST, GL_NEAREST);
+            texture->setWrap(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->data, 0);
+        }
 
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        if(render != 0) {
             glFramebufferRenderbuffer(
                 GL_FRAMEBUFFER,
                 (depth && stencil) ? GL_DEPTH_STENCIL_ATTACHMENT :
                 depth ? GL_DEPTH_ATTACHMENT : GL_STENCIL_ATTACHMENT,
                 GL_RENDERBUFFER, render
             );
-        } else {
-            render = 0;
         }
 
         end();
@@ -64,55 +59,35 @@ namespace Fantasy {
     FrameBuffer::~FrameBuffer() {
         if(texture != nullptr) delete texture;
         if(render != 0) glDeleteRenderbuffers(1, &render);
+        GLState::forgetFramebuffer(data);
         glDeleteFramebuffers(1, &data);
     }
 
+    // Only touches GPU memory when the size leaves its bucket, and even then keeps the same GL objects.
     void FrameBuffer::resize(int width, int height) {
-        if(capturing || (this->width == width && this->height == height)) return;
+        if(capturing) return;
 
-        this->~FrameBuffer();
-        before = nullptr;
-        capturing = false;
         this->width = width;
         this->height = height;
 
-        glGenFramebuffers(1, &data);
-        begin();
-
-        if(hasColor) {
-            texture = new Tex2D(width, height, nullptr);
-            texture->load();
-            texture->setFilter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
-            texture->setWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
-
-            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->data, 0);
-        } else {
-            texture = nullptr;
+        int w = bucket(width), h = bucket(height);
+        if(w > allocWidth || h > allocHeight || w * 2 < allocWidth || h * 2 < allocHeight) {
+            allocWidth = w;
+            allocHeight = h;
+            allocate();
         }
+    }
 
-        if(hasDepth || hasStencil) {
-            glGenRenderbuffers(1, &render);
-            glBindRenderbuffer(GL_RENDERBUFFER, render);
-
-            glRenderbufferStorage(
-                GL_RENDERBUFFER,
-                (hasDepth && hasStencil) ? GL_DEPTH24_STENCIL8 :
-                hasDepth ? GL_DEPTH_COMPONENT24 : GL_STENCIL_INDEX8,
-                width, height
-            );
+    void FrameBuffer::setFilter(int min, int mag) {
+        if(texture != nullptr) texture->setFilter(min, mag);
+    }
 
-            glBindRenderbuffer(GL_RENDERBUFFER, 0);
-            glFramebufferRenderbuffer(
-                GL_FRAMEBUFFER,
-                (hasDepth && hasStencil) ? GL_DEPTH_STENCIL_ATTACHMENT :
-                hasDepth ? GL_DEPTH_ATTACHMENT : GL_STENCIL_ATTACHMENT,
-                GL_RENDERBUFFER, render
-            );
-        } else {
-            render = 0;
-        }
+    float FrameBuffer::scaleX() {
+        return (float)width / allocWidth;
+    }
 
-        end();
+    float FrameBuffer::scaleY() {
+        return (float)height / allocHeight;
     }
 
     void FrameBuffer::begin() {
@@ -122,8 +97,8 @@ namespace Fantasy {
         before = last;
         last = this;
 
-        glBindFramebuffer(GL_FRAMEBUFFER, data);
-        glViewport(0, 0, width, height);
+        GLState::bindFramebuffer(data);
+        GLState::viewport(0, 0, width, height);
     }
 
     void FrameBuffer::end() {
@@ -131,8 +106,38 @@ namespace Fantasy {
         capturing = false;
 
         last = before;
-        glBindFramebuffer(GL_FRAMEBUFFER, before == nullptr ? 0 : before->data);
+        if(before == nullptr) {
+            GLState::bindFramebuffer(0);
+            GLState::windowViewport();
+        } else {
+            GLState::bindFramebuffer(before->data);
+            GLState::viewport(0, 0, before->width, before->height);
+        }
+
         before = nullptr;
-        glViewport(0, 0, App::instance->getWidth(), App::instance->getHeight());
+    }
+
+    int FrameBuffer::bucket(int size) {
+        int step = size <= 512 ? 32 : 128;
+        return size <= 0 ? step : (size + step - 1) / step * step;
+    }
+
+    void FrameBuffer::allocate() {
+        if(texture != nullptr) {
+            texture->width = allocWidth;
+            texture->height = allocHeight;
+            texture->set(nullptr);
+        }
+
+        if(render != 0) {
+            glBindRenderbuffer(GL_RENDERBUFFER, render);
+            glRenderbufferStorage(
+                GL_RENDERBUFFER,
+                (hasDepth && hasStencil) ? GL_DEPTH24_STENCIL8 :
+                hasDepth ? GL_DEPTH_COMPONENT24 : GL_STENCIL_INDEX8,
+                allocWidth, allocHeight
+            );
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        }
     }
 }
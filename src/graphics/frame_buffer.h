@@ -4,6 +4,8 @@
 #include "tex.h"
 
 namespace Fantasy {
+    // Storage is allocated in size buckets, so `width` and `height` may cover only the bottom left part of the
+    // attachments. Samplers have to scale their coordinates by `scaleX()` and `scaleY()`.
     class FrameBuffer {
         private:
         static FrameBuffer *last;
@@ -15,6 +17,7 @@ namespace Fantasy {
         Tex2D *texture;
         unsigned int render;
         int width, height;
+        int allocWidth, allocHeight;
         bool hasColor, hasDepth, hasStencil;
 
         public:
@@ -26,8 +29,16 @@ namespace Fantasy {
         ~FrameBuffer();
 
         void resize(int width, int height);
+        void setFilter(int, int);
+        float scaleX();
+        float scaleY();
         void begin();
         void end();
+
+        static int bucket(int);
+
+        private:
+        void allocate();
     };
 }
 
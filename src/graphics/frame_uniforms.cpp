@@ -0,0 +1,61 @@
+#include <GL/glew.h>
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "frame_uniforms.h"
+
+namespace Fantasy {
+    FrameUniforms::FrameUniforms() {
+        std::memset(&block, 0, sizeof(Block));
+        block.proj[0] = block.proj[5] = block.proj[10] = block.proj[15] = 1.0f;
+        block.zoom[0] = block.zoom[1] = 1.0f;
+        uploaded = block;
+
+        glGenBuffers(1, &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, data);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), &block, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, data);
+    }
+
+    FrameUniforms::~FrameUniforms() {
+        glDeleteBuffers(1, &data);
+    }
+
+    void FrameUniforms::proj(const glm::mat4 &projection) {
+        std::memcpy(block.proj, glm::value_ptr(projection), sizeof(block.proj));
+    }
+
+    void FrameUniforms::resolution(float width, float height) {
+        block.resolution[0] = width;
+        block.resolution[1] = height;
+    }
+
+    void FrameUniforms::camera(float x, float y) {
+        block.camera[0] = x;
+        block.camera[1] = y;
+    }
+
+    glm::vec2 FrameUniforms::camera() const {
+        return glm::vec2(block.camera[0], block.camera[1]);
+    }
+
+    void FrameUniforms::zoom(float x, float y) {
+        block.zoom[0] = x;
+        block.zoom[1] = y;
+    }
+
+    void FrameUniforms::time(float time) {
+        block.time = time;
+    }
+
+    // Cheap enough to call before every draw; only changed contents reach the driver.
+    void FrameUniforms::upload() {
+        if(std::memcmp(&block, &uploaded, sizeof(Block)) == 0) return;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, data);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        uploaded = block;
+    }
+}
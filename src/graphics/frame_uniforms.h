@@ -0,0 +1,48 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glm/mat4x4.hpp>
+
+namespace Fantasy {
+    // Backs the std140 `Frame` block every program may declare, bound to the same binding point so one upload serves
+    // all of them:
+    //
+    // layout(std140) uniform Frame {
+    //     mat4 u_proj;
+    //     vec2 u_resolution;
+    //     vec2 u_camera;
+    //     vec2 u_zoom;
+    //     float u_time;
+    // };
+    class FrameUniforms {
+        private:
+        struct Block {
+            float proj[16];
+            float resolution[2];
+            float camera[2];
+            float zoom[2];
+            float time;
+            float padding;
+        };
+
+        unsigned int data;
+        Block block, uploaded;
+
+        public:
+        static const unsigned int binding = 0;
+
+        public:
+        FrameUniforms();
+        ~FrameUniforms();
+
+        void proj(const glm::mat4 &);
+        void resolution(float, float);
+        void camera(float, float);
+        glm::vec2 camera() const;
+        void zoom(float, float);
+        void time(float);
+        void upload();
+    };
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include <GL/glew.h>
+
+#include "gl_state.h"
+
+namespace Fantasy {
+    // Unknown until first set, so these never match a real request. Texture bindings do start out as GL's own zero.
+    unsigned int GLState::program = ~0u;
+    int GLState::unit = -1;
+    unsigned int GLState::textures[units][2] = {};
+    unsigned int GLState::framebuffer = ~0u;
+    unsigned int GLState::vertexArray = ~0u;
+    int GLState::view[4] = {-1, -1, -1, -1};
+    int GLState::blending = -1;
+    unsigned int GLState::blendSrc = ~0u, GLState::blendDst = ~0u, GLState::blendSrcAlpha = ~0u, GLState::blendDstAlpha = ~0u;
+    int GLState::windowWidth = 0, GLState::windowHeight = 0;
+    GLStats GLState::stats = {0, 0};
+
+    void GLState::useProgram(unsigned int program) {
+        if(!changed(GLState::program != program)) return;
+
+        GLState::program = program;
+        glUseProgram(program);
+    }
+
+    void GLState::activeTexture(int unit) {
+        if(!changed(GLState::unit != unit)) return;
+
+        GLState::unit = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    // Binds to whichever unit is active, for uploads and parameter changes.
+    void GLState::bindTexture(unsigned int target, unsigned int texture) {
+        if(unit < 0) activeTexture(0);
+        bindTexture(unit, target, texture);
+    }
+
+    // Only switches units when the texture isn't bound there already.
+    void GLState::bindTexture(int unit, unsigned int target, unsigned int texture) {
+        unsigned int &bound = textures[unit][target == GL_TEXTURE_2D_ARRAY ? 1 : 0];
+        if(!changed(bound != texture)) return;
+
+        activeTexture(unit);
+        bound = texture;
+        glBindTexture(target, texture);
+    }
+
+    void GLState::bindFramebuffer(unsigned int framebuffer) {
+        if(!changed(GLState::framebuffer != framebuffer)) return;
+
+        GLState::framebuffer = framebuffer;
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    }
+
+    bool GLState::bindVertexArray(unsigned int vertexArray) {
+        if(!changed(GLState::vertexArray != vertexArray)) return false;
+
+        GLState::vertexArray = vertexArray;
+        glBindVertexArray(vertexArray);
+        return true;
+    }
+
+    void GLState::viewport(int x, int y, int width, int height) {
+        if(!changed(view[0] != x || view[1] != y || view[2] != width || view[3] != height)) return;
+
+        view[0] = x;
+        view[1] = y;
+        view[2] = width;
+        view[3] = height;
+        glViewport(x, y, width, height);
+    }
+
+    void GLState::blend(bool enabled) {
+        if(!changed(blending != (int)enabled)) return;
+
+        blending = enabled;
+        if(enabled) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+    }
+
+    bool GLState::blended() {
+        if(blending < 0) blending = glIsEnabled(GL_BLEND) == GL_TRUE;
+        return blending;
+    }
+
+    void GLState::blendFunc(unsigned int src, unsigned int dst) {
+        blendFunc(src, dst, src, dst);
+    }
+
+    void GLState::blendFunc(unsigned int src, unsigned int dst, unsigned int srcAlpha, unsigned int dstAlpha) {
+        if(!changed(blendSrc != src || blendDst != dst || blendSrcAlpha != srcAlpha || blendDstAlpha != dstAlpha)) return;
+
+        blendSrc = src;
+        blendDst = dst;
+        blendSrcAlpha = srcAlpha;
+        blendDstAlpha = dstAlpha;
+        glBlendFuncSeparate(src, dst, srcAlpha, dstAlpha);
+    }
+
+    // The default framebuffer's size, set once a frame so restoring its viewport doesn't have to ask the window.
+    void GLState::window(int width, int height) {
+        windowWidth = width;
+        windowHeight = height;
+    }
+
+    void GLState::windowViewport() {
+        viewport(0, 0, windowWidth, windowHeight);
+    }
+
+    void GLState::forgetProgram(unsigned int program) {
+        if(GLState::program == program) GLState::program = ~0u;
+    }
+
+    void GLState::forgetTexture(unsigned int texture) {
+        for(int i = 0; i < units; i++) {
+            for(int j = 0; j < 2; j++) {
+                if(textures[i][j] == texture) textures[i][j] = ~0u;
+            }
+        }
+    }
+
+    void GLState::forgetFramebuffer(unsigned int framebuffer) {
+        if(GLState::framebuffer == framebuffer) GLState::framebuffer = ~0u;
+    }
+
+    void GLState::forgetVertexArray(unsigned int vertexArray) {
+        if(GLState::vertexArray == vertexArray) GLState::vertexArray = ~0u;
+    }
+
+    void GLState::resetStats() {
+        stats = {0, 0};
+    }
+
+    bool GLState::changed(bool differs) {
+        if(differs) {
+            stats.issued++;
+        } else {
+            stats.elided++;
+        }
+
+        return differs;
+    }
+}
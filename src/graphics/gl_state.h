@@ -0,0 +1,60 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <cstddef>
+
+namespace Fantasy {
+    struct GLStats {
+        size_t issued;
+        size_t elided;
+    };
+
+    // Mirrors the bits of context state the renderer changes, so requests that wouldn't change anything never reach
+    // the driver. Everything touching this state has to go through here, or the mirror goes stale. GL names are reused
+    // once deleted, hence the `forget` calls.
+    class GLState {
+        private:
+        static const int units = 16;
+
+        static unsigned int program;
+        static int unit;
+        static unsigned int textures[units][2];
+        static unsigned int framebuffer;
+        static unsigned int vertexArray;
+        static int view[4];
+        static int blending;
+        static unsigned int blendSrc, blendDst, blendSrcAlpha, blendDstAlpha;
+        static int windowWidth, windowHeight;
+
+        public:
+        static GLStats stats;
+
+        public:
+        static void useProgram(unsigned int);
+        static void activeTexture(int);
+        static void bindTexture(unsigned int, unsigned int);
+        static void bindTexture(int, unsigned int, unsigned int);
+        static void bindFramebuffer(unsigned int);
+        static bool bindVertexArray(unsigned int);
+        static void viewport(int, int, int, int);
+        static void blend(bool);
+        static bool blended();
+        static void blendFunc(unsigned int, unsigned int);
+        static void blendFunc(unsigned int, unsigned int, unsigned int, unsigned int);
+
+        static void window(int, int);
+        static void windowViewport();
+
+        static void forgetProgram(unsigned int);
+        static void forgetTexture(unsigned int);
+        static void forgetFramebuffer(unsigned int);
+        static void forgetVertexArray(unsigned int);
+
+        static void resetStats();
+
+        private:
+        static bool changed(bool);
+    };
+}
+
+#endif
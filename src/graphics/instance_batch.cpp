@@ -0,0 +1,119 @@
+#include <stdexcept>
+
+#include "instance_batch.h"
+
+static constexpr const char *INSTANCE_VERTEX_SHADER = R"(
+#version 150 core
+
+in vec2 a_position;
+in vec4 a_transform;
+in vec4 a_bounds;
+in vec4 a_region;
+in float a_layer;
+in vec4 a_color;
+in vec4 a_tint;
+
+out vec3 v_tex_coords;
+out vec4 v_color;
+out vec4 v_tint;
+
+layout(std140) uniform Frame {
+    mat4 u_proj;
+    vec2 u_resolution;
+    vec2 u_camera;
+    vec2 u_zoom;
+    float u_time;
+};
+
+void main() {
+    vec2 local = a_bounds.xy + a_position * a_bounds.zw;
+    vec2 world = a_transform.xy + vec2(
+        local.x * a_transform.w - local.y * a_transform.z,
+        local.x * a_transform.z + local.y * a_transform.w
+    );
+
+    gl_Position = u_proj * vec4(world, 1.0, 1.0);
+    v_tex_coords = vec3(mix(a_region.xy, a_region.zw, a_position), a_layer);
+    v_color = a_color;
+    v_tint = a_tint;
+})";
+
+namespace Fantasy {
+    static void writeInstances(float *out, const SpriteInstance *sprites, size_t count) {
+        for(size_t i = 0; i < count; i++, out += 15) {
+            const SpriteInstance &sprite = sprites[i];
+            const TexRegion &region = *sprite.region;
+
+            out[0] = sprite.x;
+            out[1] = sprite.y;
+            out[2] = sprite.sin;
+            out[3] = sprite.cos;
+            out[4] = sprite.originX;
+            out[5] = sprite.originY;
+            out[6] = sprite.width;
+            out[7] = sprite.height;
+            out[8] = region.u;
+            out[9] = region.v;
+            out[10] = region.u2;
+            out[11] = region.v2;
+            out[12] = region.layer;
+            writeBits(out + 13, sprite.color);
+            writeBits(out + 14, sprite.tint);
+        }
+    }
+
+    static const SpriteFormat instanceFormat = {
+        4 + // Position, rotation sine and cosine.
+        4 + // Origin and size.
+        4 + // Texture region.
+        1 + // Array layer.
+        1 + // Base color.
+        1,  // Tint color.
+        writeInstances
+    };
+
+    static Mesh *createInstances(size_t size) {
+        if(size == 0) throw std::runtime_error("Instance batches can't be empty.");
+
+        return new Mesh(size, 0, 6, new VertexAttr[6]{
+            VertexAttr(4, GL_FLOAT, "a_transform"),
+            VertexAttr(4, GL_FLOAT, "a_bounds"),
+            VertexAttr(4, GL_FLOAT, "a_region"),
+            VertexAttr(1, GL_FLOAT, "a_layer"),
+            VertexAttr::color,
+            VertexAttr::tint
+        }, true);
+    }
+
+    InstanceBatch::InstanceBatch(): InstanceBatch(32768, nullptr) {}
+    InstanceBatch::InstanceBatch(size_t size, Shader *shader): SpriteBatch(
+        instanceFormat, size, createInstances(size),
+        shader == nullptr ? new Shader(INSTANCE_VERTEX_SHADER, fragmentSource) : shader,
+        new Shader(INSTANCE_VERTEX_SHADER, arrayFragmentSource)
+    ) {
+        // Corners are in the same order the vertex batch writes them.
+        float corners[] = {
+            0.0f, 0.0f,
+            1.0f, 0.0f,
+            1.0f, 1.0f,
+            0.0f, 1.0f
+        };
+        unsigned short indices[] = {0, 1, 2, 2, 3, 0};
+
+        quad = new Mesh(4, 6, 1, new VertexAttr[1]{VertexAttr::position2D});
+        quad->setVertices(corners, 0, sizeof(corners) / sizeof(float));
+        quad->setIndices(indices, 0, sizeof(indices) / sizeof(unsigned short));
+    }
+
+    InstanceBatch::~InstanceBatch() {
+        delete quad;
+    }
+
+    bool InstanceBatch::supported() {
+        return GLEW_VERSION_3_3;
+    }
+
+    void InstanceBatch::render(Shader *shader, size_t count) {
+        quad->render(shader, GL_TRIANGLES, 0, 6, mesh, count);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef INSTANCE_BATCH_H
+#define INSTANCE_BATCH_H
+
+#include "sprite_batch.h"
+
+namespace Fantasy {
+    // Streams one record per sprite and expands a shared unit quad in the vertex shader.
+    class InstanceBatch: public SpriteBatch {
+        private:
+        Mesh *quad;
+
+        public:
+        InstanceBatch();
+        InstanceBatch(size_t, Shader *);
+        ~InstanceBatch() override;
+
+        static bool supported();
+
+        protected:
+        void render(Shader *, size_t) override;
+    };
+}
+
+#endif
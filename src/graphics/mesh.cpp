@@ -1,9 +1,11 @@
 #include <SDL.h>
 #include <GL/glew.h>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 
 #include "mesh.h"
+#include "gl_state.h"
 
 using namespace std;
 
@@ -11,13 +13,18 @@ namespace Fantasy {
     const VertexAttr VertexAttr::position = VertexAttr(3, GL_FLOAT, "a_position");
     const VertexAttr VertexAttr::position2D = VertexAttr(2, GL_FLOAT, "a_position");
     const VertexAttr VertexAttr::texCoords = VertexAttr(2, GL_FLOAT, "a_tex_coords_0");
+    const VertexAttr VertexAttr::texCoordsLayered = VertexAttr(3, GL_FLOAT, "a_tex_coords_0");
     const VertexAttr VertexAttr::color = VertexAttr(4, GL_UNSIGNED_BYTE, true, "a_color");
     const VertexAttr VertexAttr::tint = VertexAttr(4, GL_UNSIGNED_BYTE, true, "a_tint");
+    const VertexAttr VertexAttr::positionHalf = VertexAttr(2, GL_HALF_FLOAT, "a_position");
+    const VertexAttr VertexAttr::texCoordsPacked = VertexAttr(2, GL_UNSIGNED_SHORT, true, "a_tex_coords_0");
+    const VertexAttr VertexAttr::layer = VertexAttr::integral(1, GL_UNSIGNED_INT, "a_layer");
 
     VertexAttr::VertexAttr(int components, int type, bool normalized, const char *alias) {
         this->components = components;
         this->type = type;
         this->normalized = normalized;
+        this->integer = false;
         this->alias = alias;
 
         switch(type) {
@@ -25,12 +32,17 @@ namespace Fantasy {
             case GL_FIXED:
                 size = sizeof(float) * components;
                 break;
+            case GL_UNSIGNED_INT:
+            case GL_INT:
+                size = sizeof(int) * components;
+                break;
             case GL_UNSIGNED_BYTE:
             case GL_BYTE:
                 size = components;
                 break;
             case GL_UNSIGNED_SHORT:
             case GL_SHORT:
+            case GL_HALF_FLOAT:
                 size = sizeof(short) * components;
                 break;
             default:
@@ -38,11 +50,22 @@ namespace Fantasy {
         }
     }
 
-    Mesh::Mesh(size_t maxVertices, size_t maxIndices, size_t attrCount, VertexAttr *attributes) {
+    VertexAttr VertexAttr::integral(int components, int type, const char *alias) {
+        if(type == GL_FLOAT || type == GL_FIXED || type == GL_HALF_FLOAT) throw std::runtime_error("Integer attributes need an integer type.");
+
+        VertexAttr attr(components, type, false, alias);
+        attr.integer = true;
+        return attr;
+    }
+
+    MeshStats Mesh::stats = {0, 0, 0, 0};
+
+    Mesh::Mesh(size_t maxVertices, size_t maxIndices, size_t attrCount, VertexAttr *attributes, bool streaming) {
         this->maxVertices = maxVertices;
         this->maxIndices = maxIndices;
         this->attrCount = attrCount;
         this->attributes = attributes;
+        this->streaming = streaming;
 
         vertSize = 0;
         for(size_t i = 0; i < attrCount; i++) {
@@ -50,70 +73,294 @@ namespace Fantasy {
             vertSize += a.size;
         }
 
-        vertices = new float[maxVertices * vertSize];
-        indices = new unsigned short[maxIndices];
+        indexType = GL_UNSIGNED_SHORT;
+        fenced = streaming && (GLEW_VERSION_3_2 || GLEW_ARB_sync);
+        persistent = fenced && GLEW_ARB_buffer_storage;
+        regionSize = maxVertices * vertSize;
+        region = 0;
+        cursor = 0;
+        base = 0;
+        mapped = nullptr;
+        for(size_t i = 0; i < regions; i++) fences[i] = nullptr;
+        arrays = new std::vector<VertexArray>();
+        users = new std::vector<Mesh *>();
 
         glGenBuffers(1, &verticesData);
         glBindBuffer(GL_ARRAY_BUFFER, verticesData);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        if(!streaming) {
+            glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STATIC_DRAW);
+        } else if(persistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_ARRAY_BUFFER, regionSize * regions, nullptr, flags);
+            mapped = (char *)glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * regions, flags);
+            if(mapped == nullptr) throw std::runtime_error("Couldn't persistently map vertex buffer.");
+        } else {
+            glBufferData(GL_ARRAY_BUFFER, regionSize * regions, nullptr, GL_STREAM_DRAW);
+        }
         glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+        // The element binding belongs to whichever vertex array is bound, so never touch it with one bound.
+        GLState::bindVertexArray(0);
         glGenBuffers(1, &indicesData);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesData);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, maxIndices * sizeof(unsigned short), nullptr, GL_STATIC_DRAW);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
     Mesh::~Mesh() {
         delete[] attributes;
 
-        glDeleteBuffers(1, &verticesData);
-        delete[] vertices;
+        for(Mesh *user : *users) {
+            if(user != this) user->forget(this);
+        }
+        delete users;
+
+        for(VertexArray &array : *arrays) {
+            if(array.instances != nullptr && array.instances != this) {
+                std::vector<Mesh *> &others = *array.instances->users;
+                others.erase(std::remove(others.begin(), others.end(), this), others.end());
+            }
+
+            GLState::forgetVertexArray(array.data);
+            glDeleteVertexArrays(1, &array.data);
+        }
+        delete arrays;
 
+        if(mapped != nullptr) {
+            glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        for(size_t i = 0; i < regions; i++) {
+            if(fences[i] != nullptr) glDeleteSync(fences[i]);
+        }
+
+        glDeleteBuffers(1, &verticesData);
         glDeleteBuffers(1, &indicesData);
-        delete[] indices;
     }
 
     void Mesh::setVertices(float *vertices, size_t offset, size_t count) {
-        SDL_memcpy(this->vertices, vertices + offset, count * sizeof(float));
+        if(streaming) {
+            size_t granted;
+            float *out = map(count, count, granted);
+            if(granted < count) throw std::runtime_error("Vertices don't fit in a streaming mesh region.");
+
+            SDL_memcpy(out, vertices + offset, count * sizeof(float));
+            unmap(count);
+            return;
+        }
 
         glBindBuffer(GL_ARRAY_BUFFER, verticesData);
-        glBufferData(GL_ARRAY_BUFFER, count * sizeof(float), this->vertices, GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(float), vertices + offset, GL_STATIC_DRAW);
+    }
+
+    // Overwrites part of a static mesh in place; the offset and count are in floats.
+    void Mesh::updateVertices(const float *vertices, size_t at, size_t count) {
+        if(streaming) throw std::runtime_error("Streaming meshes are written through map().");
+
+        glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+        glBufferSubData(GL_ARRAY_BUFFER, at * sizeof(float), count * sizeof(float), vertices);
+    }
+
+    // Where draws start reading a static mesh; instanced draws take it as their base instance. Streaming meshes move
+    // it themselves.
+    void Mesh::first(size_t vertex) {
+        if(streaming) throw std::runtime_error("Streaming meshes can't be rebased.");
+        base = vertex * vertSize;
     }
 
     void Mesh::setIndices(unsigned short *indices, size_t offset, size_t count) {
-        SDL_memcpy(this->indices, indices + offset, count * sizeof(unsigned short));
+        indexType = GL_UNSIGNED_SHORT;
 
+        GLState::bindVertexArray(0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesData);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned short), this->indices, GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned short), indices + offset, GL_STATIC_DRAW);
     }
 
-    void Mesh::render(Shader *shader, unsigned int type, size_t offset, size_t count) {
-        bind(shader);
-        glDrawElements(type, count, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(offset));
-        unbind(shader);
+    void Mesh::setIndices(unsigned int *indices, size_t offset, size_t count) {
+        indexType = GL_UNSIGNED_INT;
+
+        GLState::bindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesData);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), indices + offset, GL_STATIC_DRAW);
     }
 
-    void Mesh::bind(Shader *shader) {
+    // Hands out between min and max floats of the current ring region. Every range is written once and only reused
+    // after the fence placed when leaving its region has signaled, so the mapping never has to synchronize.
+    float *Mesh::map(size_t min, size_t max, size_t &granted) {
+        if(!streaming) throw std::runtime_error("Only streaming meshes can be mapped.");
+        if(min * sizeof(float) > regionSize) throw std::runtime_error("Mapped range is larger than a mesh region.");
+
+        size_t end = (region + 1) * regionSize;
+        if(cursor + min * sizeof(float) > end) {
+            advance();
+            end = cursor + regionSize;
+        }
+
+        size_t bytes = max * sizeof(float);
+        if(bytes > end - cursor) bytes = end - cursor;
+        bytes -= bytes % vertSize;
+        granted = bytes / sizeof(float);
+
+        if(persistent) return (float *)(mapped + cursor);
+
         glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+        void *range = glMapBufferRange(GL_ARRAY_BUFFER, cursor, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if(range == nullptr) throw std::runtime_error("Couldn't map vertex buffer.");
+        return (float *)range;
+    }
+
+    void Mesh::unmap(size_t count) {
+        if(!persistent) {
+            glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+            if(!glUnmapBuffer(GL_ARRAY_BUFFER)) SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Vertex buffer was lost while mapped.");
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+
+        base = cursor;
+        cursor += count * sizeof(float);
+    }
+
+    void Mesh::advance() {
+        if(fenced) fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        region = (region + 1) % regions;
+        cursor = region * regionSize;
 
-        size_t off = 0;
+        if(fenced && fences[region] != nullptr) {
+            while(glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+            glDeleteSync(fences[region]);
+            fences[region] = nullptr;
+        } else if(!fenced && region == 0) {
+            // No sync objects; orphan the store on wrap so the driver hands out memory the GPU isn't reading.
+            glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+            glBufferData(GL_ARRAY_BUFFER, regionSize * regions, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    // Streaming meshes move `base` every flush; drawing with a base vertex keeps the attribute pointers at zero so the
+    // cached vertex array stays valid. Drivers without it get the pointers moved instead.
+    void Mesh::render(Shader *shader, unsigned int type, size_t offset, size_t count) {
+        size_t indexSize = indexType == GL_UNSIGNED_INT ? sizeof(unsigned int) : sizeof(unsigned short);
+        void *indices = reinterpret_cast<void *>(offset * indexSize);
+
+        use(shader, nullptr);
+        if(GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex) {
+            glDrawElementsBaseVertex(type, count, indexType, indices, base / vertSize);
+        } else {
+            glDrawElements(type, count, indexType, indices);
+        }
+
+        stats.draws++;
+    }
+
+    // Draws this mesh once per element of the other mesh, whose attributes advance per instance.
+    void Mesh::render(Shader *shader, unsigned int type, size_t offset, size_t count, Mesh *instances, size_t instanceCount) {
+        size_t indexSize = indexType == GL_UNSIGNED_INT ? sizeof(unsigned int) : sizeof(unsigned short);
+        void *indices = reinterpret_cast<void *>(offset * indexSize);
+
+        use(shader, instances);
+        if(GLEW_VERSION_4_2 || GLEW_ARB_base_instance) {
+            glDrawElementsInstancedBaseInstance(type, count, indexType, indices, instanceCount, instances->base / instances->vertSize);
+        } else {
+            glDrawElementsInstanced(type, count, indexType, indices, instanceCount);
+        }
+
+        stats.draws++;
+    }
+
+    void Mesh::resetStats() {
+        stats = {0, 0, 0, 0};
+    }
+
+    void Mesh::use(Shader *shader, Mesh *instances) {
+        VertexArray *array = nullptr;
+        for(VertexArray &entry : *arrays) {
+            if(entry.shader == shader->id && entry.instances == instances) {
+                array = &entry;
+                break;
+            }
+        }
+
+        // Without the array, every draw would bind both buffers, enable and point each attribute, then disable them
+        // and unbind again.
+        size_t calls = 4 + attrCount * 3, issued = 0;
+        if(instances != nullptr) calls += 2 + instances->attrCount * 5;
+
+        bool created = array == nullptr;
+        if(created) {
+            arrays->push_back({shader->id, instances, 0, 0, 0});
+            array = &arrays->back();
+
+            glGenVertexArrays(1, &array->data);
+            if(instances != nullptr && std::find(instances->users->begin(), instances->users->end(), this) == instances->users->end()) {
+                instances->users->push_back(this);
+            }
+        }
+
+        if(GLState::bindVertexArray(array->data)) {
+            stats.arrayBinds++;
+            issued++;
+        }
+
+        size_t vertexBase = (GLEW_VERSION_3_2 || GLEW_ARB_draw_elements_base_vertex) ? 0 : base;
+        if(created || array->base != vertexBase) {
+            glBindBuffer(GL_ARRAY_BUFFER, verticesData);
+            point(shader, vertexBase, false);
+            array->base = vertexBase;
+            stats.repoints++;
+            issued += 2 + attrCount * 2;
+        }
+
+        if(instances != nullptr) {
+            size_t instanceBase = (GLEW_VERSION_4_2 || GLEW_ARB_base_instance) ? 0 : instances->base;
+            if(created || array->instanceBase != instanceBase) {
+                glBindBuffer(GL_ARRAY_BUFFER, instances->verticesData);
+                instances->point(shader, instanceBase, true);
+                array->instanceBase = instanceBase;
+                stats.repoints++;
+                issued += 2 + instances->attrCount * 3;
+            }
+        }
+
+        if(created) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesData);
+        if(calls > issued) stats.elided += calls - issued;
+    }
+
+    // Drops the vertex arrays reading the given mesh as instances, before its buffers go and its address is reused.
+    void Mesh::forget(Mesh *instances) {
+        for(size_t i = arrays->size(); i-- > 0;) {
+            VertexArray &array = arrays->at(i);
+            if(array.instances != instances) continue;
+
+            GLState::forgetVertexArray(array.data);
+            glDeleteVertexArrays(1, &array.data);
+            arrays->erase(arrays->begin() + i);
+        }
+    }
+
+    // Records this mesh's attribute layout into the bound vertex array, reading from the bound array buffer.
+    void Mesh::point(Shader *shader, size_t offset, bool instanced) {
         for(size_t i = 0; i < attrCount; i++) {
-            VertexAttr attr = attributes[i];
+            const VertexAttr &attr = attributes[i];
             unsigned int loc = shader->attributeLoc(attr.alias);
 
             glEnableVertexAttribArray(loc);
-            glVertexAttribPointer(loc, attr.components, attr.type, attr.normalized, vertSize, reinterpret_cast<void *>(off));
+            if(attr.integer) {
+                glVertexAttribIPointer(loc, attr.components, attr.type, vertSize, reinterpret_cast<void *>(offset));
+            } else {
+                glVertexAttribPointer(loc, attr.components, attr.type, attr.normalized, vertSize, reinterpret_cast<void *>(offset));
+            }
+            if(instanced) glVertexAttribDivisor(loc, 1);
 
-            off += attr.size;
+            offset += attr.size;
         }
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesData);
-    }
-
-    void Mesh::unbind(Shader *shader) {
-        for(size_t i = 0; i < attrCount; i++) glDisableVertexAttribArray(shader->attributeLoc(attributes[i].alias));
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 }
@@ -2,6 +2,7 @@
 #define MESH_H
 
 #include <GL/glew.h>
+#include <vector>
 
 #include "shader.h"
 
@@ -11,22 +12,40 @@ namespace Fantasy {
         static const VertexAttr position;
         static const VertexAttr position2D;
         static const VertexAttr texCoords;
+        static const VertexAttr texCoordsLayered;
         static const VertexAttr color;
         static const VertexAttr tint;
+        static const VertexAttr positionHalf;
+        static const VertexAttr texCoordsPacked;
+        static const VertexAttr layer;
 
         int components;
         int type;
         bool normalized;
+        // Read as ints or uints in the shader instead of being converted to floats.
+        bool integer;
         const char *alias;
         int size;
 
         public:
         VertexAttr(int components, int type, const char *alias): VertexAttr(components, type, false, alias) {}
         VertexAttr(int, int, bool, const char *);
+
+        static VertexAttr integral(int, int, const char *);
+    };
+
+    // Draw calls and the GL calls the vertex array cache spared them since the last reset.
+    struct MeshStats {
+        size_t draws;
+        size_t arrayBinds;
+        size_t repoints;
+        size_t elided;
     };
 
     class Mesh {
         public:
+        static MeshStats stats;
+
         size_t maxVertices;
         size_t maxIndices;
         size_t vertSize;
@@ -35,20 +54,53 @@ namespace Fantasy {
         VertexAttr *attributes;
 
         private:
-        float *vertices;
-        unsigned short *indices;
+        struct VertexArray {
+            unsigned int shader;
+            Mesh *instances;
+            unsigned int data;
+            size_t base, instanceBase;
+        };
+
+        static const size_t regions = 3;
+
         unsigned int verticesData;
         unsigned int indicesData;
+        unsigned int indexType;
+
+        bool streaming;
+        bool persistent;
+        bool fenced;
+        size_t regionSize;
+        size_t region;
+        size_t cursor;
+        size_t base;
+        GLsync fences[regions];
+        char *mapped;
+        std::vector<VertexArray> *arrays;
+        // Meshes whose vertex arrays read this one as instances. They drop those arrays when this one is deleted.
+        std::vector<Mesh *> *users;
 
         public:
-        Mesh(size_t, size_t, size_t, VertexAttr *);
+        Mesh(size_t, size_t, size_t, VertexAttr *, bool streaming = false);
         ~Mesh();
 
         void setVertices(float *, size_t, size_t);
+        void updateVertices(const float *, size_t, size_t);
+        void first(size_t);
         void setIndices(unsigned short *, size_t, size_t);
+        void setIndices(unsigned int *, size_t, size_t);
+        float *map(size_t, size_t, size_t &);
+        void unmap(size_t);
         void render(Shader *, unsigned int, size_t, size_t);
-        void bind(Shader *);
-        void unbind(Shader *);
+        void render(Shader *, unsigned int, size_t, size_t, Mesh *, size_t);
+
+        static void resetStats();
+
+        private:
+        void advance();
+        void use(Shader *, Mesh *);
+        void point(Shader *, size_t, bool);
+        void forget(Mesh *);
     };
 }
 
@@ -0,0 +1,159 @@
+#include <SDL.h>
+#include <GL/glew.h>
+#include <stdexcept>
+#include <string>
+
+#include "render_graph.h"
+#include "gl_state.h"
+
+namespace Fantasy {
+    RenderGraph::RenderGraph(RenderTargets *pool) {
+        this->pool = pool;
+        targets = new std::vector<Target>();
+        passes = new std::vector<Pass *>();
+        width = height = 0;
+
+        targets->push_back({"backbuffer", 0, false, false, -1, -1, nullptr});
+    }
+
+    RenderGraph::~RenderGraph() {
+        for(Pass *pass : *passes) delete pass;
+        delete passes;
+        delete targets;
+    }
+
+    // Transient targets are sized relative to the frame, halved `shift` times.
+    int RenderGraph::target(const char *name, int shift, bool clear) {
+        targets->push_back({name, shift, clear, false, -1, -1, nullptr});
+        return targets->size() - 1;
+    }
+
+    int RenderGraph::add(const char *name, std::initializer_list<int> reads, int write, bool blend, const std::function<void()> &func) {
+        for(int read : reads) {
+            if(read < 0 || read >= (int)targets->size()) throw std::runtime_error(std::string("Render pass '").append(name).append("' reads an unknown target."));
+        }
+
+        if(write < 0 || write >= (int)targets->size()) throw std::runtime_error(std::string("Render pass '").append(name).append("' writes an unknown target."));
+
+        Pass *pass = new Pass();
+        pass->name = name;
+        pass->reads = reads;
+        pass->write = write;
+        pass->blend = blend;
+        pass->enabled = true;
+        pass->live = false;
+        pass->func = func;
+        passes->push_back(pass);
+
+        return passes->size() - 1;
+    }
+
+    void RenderGraph::setEnabled(int pass, bool enabled) {
+        passes->at(pass)->enabled = enabled;
+    }
+
+    FrameBuffer *RenderGraph::get(int target) {
+        return targets->at(target).buffer;
+    }
+
+    void RenderGraph::execute(int width, int height) {
+        this->width = width;
+        this->height = height;
+
+        for(Target &target : *targets) {
+            target.needed = false;
+            target.firstUse = target.lastUse = -1;
+        }
+
+        // Walking backwards from the backbuffer, a pass survives only if a surviving pass reads what it writes.
+        targets->at(BACKBUFFER).needed = true;
+        for(int i = passes->size() - 1; i >= 0; i--) {
+            Pass *pass = passes->at(i);
+            pass->live = pass->enabled && targets->at(pass->write).needed;
+            if(pass->live) for(int read : pass->reads) targets->at(read).needed = true;
+        }
+
+        for(int i = 0; i < (int)passes->size(); i++) {
+            Pass *pass = passes->at(i);
+            if(!pass->live) continue;
+
+            for(int read : pass->reads) {
+                Target &target = targets->at(read);
+                if(target.firstUse == -1) target.firstUse = i;
+                target.lastUse = i;
+            }
+
+            Target &target = targets->at(pass->write);
+            if(target.firstUse == -1) target.firstUse = i;
+            target.lastUse = i;
+        }
+
+        int current = -1;
+        for(int i = 0; i < (int)passes->size(); i++) {
+            Pass *pass = passes->at(i);
+            if(!pass->live) continue;
+
+            if(pass->write != current) {
+                if(current > BACKBUFFER) targets->at(current).buffer->end();
+
+                current = pass->write;
+                bind(current, i);
+            }
+
+            GLState::blend(pass->blend);
+            pass->func();
+
+            // A target still bound for drawing can go back too; nothing borrows before it's unbound.
+            for(int read : pass->reads) {
+                Target &target = targets->at(read);
+                if(target.lastUse == i && read != BACKBUFFER) {
+                    pool->release(target.buffer);
+                    target.buffer = nullptr;
+                }
+            }
+
+            Target &target = targets->at(pass->write);
+            if(target.lastUse == i && target.buffer != nullptr) pool->release(target.buffer);
+        }
+
+        if(current > BACKBUFFER) targets->at(current).buffer->end();
+        for(Target &target : *targets) target.buffer = nullptr;
+    }
+
+    void RenderGraph::log() {
+        int current = -1;
+        for(Pass *pass : *passes) {
+            std::string reads;
+            for(int read : pass->reads) reads.append(reads.empty() ? "" : ", ").append(targets->at(read).name);
+
+            SDL_Log(
+                "[pass] %s: %s%s-> %s%s",
+                pass->name,
+                reads.c_str(), reads.empty() ? "" : " ",
+                targets->at(pass->write).name,
+                !pass->live ? " (culled)" : pass->write == current ? " (merged)" : ""
+            );
+
+            if(pass->live) current = pass->write;
+        }
+    }
+
+    void RenderGraph::bind(int index, int pass) {
+        if(index == BACKBUFFER) {
+            GLState::viewport(0, 0, width, height);
+            return;
+        }
+
+        Target &target = targets->at(index);
+        if(target.buffer == nullptr) {
+            int w = width >> target.shift, h = height >> target.shift;
+            target.buffer = pool->borrow(w < 1 ? 1 : w, h < 1 ? 1 : h);
+        }
+
+        target.buffer->begin();
+        if(target.clear && target.firstUse == pass) {
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "render_targets.h"
+
+namespace Fantasy {
+    // Passes are declared once with the targets they read and the one they write, then executed every frame. Passes
+    // that are disabled or whose output nothing live reads are culled, consecutive passes into the same target share
+    // one bind, and transient targets are borrowed from the pool right before their first use and returned right after
+    // their last, so targets whose lifetimes don't overlap end up sharing storage.
+    class RenderGraph {
+        public:
+        static const int BACKBUFFER = 0;
+
+        private:
+        struct Target {
+            const char *name;
+            int shift;
+            bool clear;
+            bool needed;
+            int firstUse, lastUse;
+            FrameBuffer *buffer;
+        };
+
+        struct Pass {
+            const char *name;
+            std::vector<int> reads;
+            int write;
+            bool blend, enabled, live;
+            std::function<void()> func;
+        };
+
+        RenderTargets *pool;
+        std::vector<Target> *targets;
+        std::vector<Pass *> *passes;
+        int width, height;
+
+        public:
+        RenderGraph(RenderTargets *);
+        ~RenderGraph();
+
+        int target(const char *, int shift = 0, bool clear = false);
+        int add(const char *, std::initializer_list<int>, int, bool, const std::function<void()> &);
+        void setEnabled(int, bool);
+
+        FrameBuffer *get(int);
+        void execute(int, int);
+        void log();
+
+        private:
+        void bind(int, int);
+    };
+}
+
+#endif
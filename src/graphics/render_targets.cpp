@@ -0,0 +1,89 @@
+#include <GL/glew.h>
+
+#include "render_targets.h"
+
+namespace Fantasy {
+    static constexpr unsigned long EVICT_FRAMES = 120;
+
+    RenderTargets::RenderTargets() {
+        targets = new std::vector<Target>();
+        frame = 0;
+    }
+
+    RenderTargets::~RenderTargets() {
+        for(Target &target : *targets) delete target.buffer;
+        delete targets;
+    }
+
+    FrameBuffer *RenderTargets::borrow(int width, int height, bool depth, bool stencil) {
+        int w = FrameBuffer::bucket(width), h = FrameBuffer::bucket(height);
+
+        // Prefer a target whose storage already fits. Failing that, one no pass has had this frame gets reallocated
+        // rather than left to idle out, so the old sizes of a window being resized don't pile up.
+        Target *found = nullptr;
+        for(Target &target : *targets) {
+            FrameBuffer *buffer = target.buffer;
+            if(target.borrowed || buffer->hasDepth != depth || buffer->hasStencil != stencil) continue;
+
+            if(w <= buffer->allocWidth && h <= buffer->allocHeight && w * 2 >= buffer->allocWidth && h * 2 >= buffer->allocHeight) {
+                found = &target;
+                break;
+            }
+
+            if(found == nullptr && target.lastUsed != frame) found = &target;
+        }
+
+        if(found != nullptr) {
+            found->borrowed = true;
+            found->lastUsed = frame;
+            found->buffer->resize(width, height);
+            return found->buffer;
+        }
+
+        FrameBuffer *buffer = new FrameBuffer(width, height, true, depth, stencil);
+        buffer->setFilter(GL_LINEAR, GL_LINEAR);
+        targets->push_back({buffer, true, frame});
+
+        return buffer;
+    }
+
+    void RenderTargets::release(FrameBuffer *buffer) {
+        for(Target &target : *targets) {
+            if(target.buffer == buffer) {
+                target.borrowed = false;
+                return;
+            }
+        }
+    }
+
+    void RenderTargets::endFrame() {
+        for(size_t i = 0; i < targets->size();) {
+            Target &target = targets->at(i);
+            target.borrowed = false;
+
+            if(frame - target.lastUsed > EVICT_FRAMES) {
+                delete target.buffer;
+                target = targets->back();
+                targets->pop_back();
+            } else {
+                i++;
+            }
+        }
+
+        frame++;
+    }
+
+    size_t RenderTargets::size() {
+        return targets->size();
+    }
+
+    size_t RenderTargets::bytes() {
+        size_t total = 0;
+        for(Target &target : *targets) {
+            FrameBuffer *buffer = target.buffer;
+            total += (size_t)buffer->allocWidth * buffer->allocHeight * ((buffer->hasDepth || buffer->hasStencil) ? 8 : 4);
+        }
+
+        return total;
+    }
+}
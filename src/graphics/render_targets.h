@@ -0,0 +1,36 @@
+#ifndef RENDER_TARGETS_H
+#define RENDER_TARGETS_H
+
+#include <vector>
+
+#include "frame_buffer.h"
+
+namespace Fantasy {
+    // Framebuffers shared between passes, matched by their attachments and size bucket. Every target is linearly
+    // filtered RGBA8, since that is all the passes need. Borrowed targets return to the pool at the end of the frame
+    // at the latest, ones left over from an earlier size get resized, and ones no pass asked for in a while get freed.
+    class RenderTargets {
+        private:
+        struct Target {
+            FrameBuffer *buffer;
+            bool borrowed;
+            unsigned long lastUsed;
+        };
+
+        std::vector<Target> *targets;
+        unsigned long frame;
+
+        public:
+        RenderTargets();
+        ~RenderTargets();
+
+        FrameBuffer *borrow(int, int, bool depth = false, bool stencil = false);
+        void release(FrameBuffer *);
+        void endFrame();
+
+        size_t size();
+        size_t bytes();
+    };
+}
+
+#endif
@@ -1,13 +1,38 @@
 #include <SDL.h>
 #include <GL/glew.h>
+#include <cstring>
 #include <string>
 #include <stdexcept>
 
 #include "shader.h"
+#include "frame_uniforms.h"
+#include "gl_state.h"
 
 namespace Fantasy {
+    static const char *UNIFORM_NAMES[(int)Uniform::COUNT] = {
+        "u_texture",
+        "u_texel",
+        "u_scale",
+        "u_threshold",
+        "u_bloom",
+        "u_bloom_scale",
+        "u_intensity",
+        "u_texture_1",
+        "u_texture_2",
+        "u_dimension_1",
+        "u_dimension_2",
+        "u_intensity_1",
+        "u_intensity_2",
+        "u_emitter"
+    };
+
+    unsigned int Shader::lastId = 0;
+
     Shader::Shader(const char *vertSource, const char *fragSource): Shader(&vertSource, &fragSource) {}
     Shader::Shader(const char **vertSource, const char **fragSource) {
+        // Never reused, unlike addresses or program names, so caches keyed on it can't pick up a stale entry.
+        id = ++lastId;
+
         vertPtr = createShader(GL_VERTEX_SHADER, vertSource);
         if(vertPtr == 0) throw std::runtime_error("Couldn't create vertex shader.");
 
@@ -26,13 +51,15 @@ namespace Fantasy {
         glGetProgramiv(progPtr, GL_LINK_STATUS, &success);
         if(success != GL_TRUE) throw std::runtime_error("Couldn't link GL program.");
 
-        uniforms = new std::unordered_map<const char *, unsigned int>();
-        attributes = new std::unordered_map<const char *, unsigned int>();
+        uniforms = new std::vector<std::pair<std::string, int>>();
+        attributes = new std::vector<std::pair<std::string, int>>();
+        reflect();
     }
 
     Shader::~Shader() {
         glDeleteShader(fragPtr);
         glDeleteShader(vertPtr);
+        GLState::forgetProgram(progPtr);
         glDeleteProgram(progPtr);
 
         delete uniforms;
@@ -90,40 +117,65 @@ namespace Fantasy {
         }
     }
 
+    int Shader::uniform(Uniform uniform) {
+        return locations[(int)uniform];
+    }
+
     unsigned int Shader::uniformLoc(const char *alias) {
-        if(!progPtr) throw std::runtime_error("Program pointer not defined.");
-        if(!uniforms->count(alias)) {
-            unsigned int loc = glGetUniformLocation(progPtr, alias);
-            if(loc == -1) {
-                std::string append(alias);
-                throw std::runtime_error(("Uniform not found: '" + append + "'.").c_str());
-            } else {
-                uniforms->emplace(alias, loc);
-                return loc;
-            }
+        for(const std::pair<std::string, int> &entry : *uniforms) {
+            if(entry.first == alias) return entry.second;
         }
 
-        return uniforms->at(alias);
+        std::string append(alias);
+        throw std::runtime_error(("Uniform not found: '" + append + "'.").c_str());
     }
 
     unsigned int Shader::attributeLoc(const char *alias) {
-        if(!progPtr) throw std::runtime_error("Program pointer not defined.");
-        if(!attributes->count(alias)) {
-            unsigned int loc = glGetAttribLocation(progPtr, alias);
-            if(loc == -1) {
-                std::string append(alias);
-                throw std::runtime_error(("Attribute not found: '" + append + "'.").c_str());
-            } else {
-                attributes->emplace(alias, loc);
-                return loc;
+        for(const std::pair<std::string, int> &entry : *attributes) {
+            if(entry.first == alias) return entry.second;
+        }
+
+        std::string append(alias);
+        throw std::runtime_error(("Attribute not found: '" + append + "'.").c_str());
+    }
+
+    // Lists what the linker kept, so lookups never reach the driver and names compare by content rather than by
+    // pointer. Members of uniform blocks have no location and are left out.
+    void Shader::reflect() {
+        for(int i = 0; i < (int)Uniform::COUNT; i++) locations[i] = -1;
+
+        char name[128];
+        int count, length, size;
+        unsigned int type;
+
+        glGetProgramiv(progPtr, GL_ACTIVE_UNIFORMS, &count);
+        for(int i = 0; i < count; i++) {
+            glGetActiveUniform(progPtr, i, sizeof(name), &length, &size, &type, name);
+
+            char *bracket = std::strchr(name, '[');
+            if(bracket != nullptr) *bracket = '\0';
+
+            int loc = glGetUniformLocation(progPtr, name);
+            if(loc == -1) continue;
+
+            uniforms->emplace_back(name, loc);
+            for(int u = 0; u < (int)Uniform::COUNT; u++) {
+                if(std::strcmp(name, UNIFORM_NAMES[u]) == 0) locations[u] = loc;
             }
         }
 
-        return attributes->at(alias);
+        glGetProgramiv(progPtr, GL_ACTIVE_ATTRIBUTES, &count);
+        for(int i = 0; i < count; i++) {
+            glGetActiveAttrib(progPtr, i, sizeof(name), &length, &size, &type, name);
+            attributes->emplace_back(name, glGetAttribLocation(progPtr, name));
+        }
+
+        unsigned int block = glGetUniformBlockIndex(progPtr, "Frame");
+        if(block != GL_INVALID_INDEX) glUniformBlockBinding(progPtr, block, FrameUniforms::binding);
     }
 
     void Shader::bind() {
         if(!progPtr) throw std::runtime_error("Program pointer not defined.");
-        glUseProgram(progPtr);
+        GLState::useProgram(progPtr);
     }
 }
@@ -1,30 +1,60 @@
 #ifndef SHADER_H
 #define SHADER_H
 
-#include <unordered_map>
+#include <string>
+#include <utility>
+#include <vector>
 #include <SDL_opengl.h>
 
 namespace Fantasy {
+    // Uniforms set per draw, resolved to locations once when the program links. Per-frame values live in the shared
+    // `Frame` block instead, see `FrameUniforms`.
+    enum class Uniform: unsigned char {
+        TEXTURE,
+        TEXEL,
+        SCALE,
+        THRESHOLD,
+        BLOOM,
+        BLOOM_SCALE,
+        INTENSITY,
+        TEXTURE_1,
+        TEXTURE_2,
+        DIMENSION_1,
+        DIMENSION_2,
+        INTENSITY_1,
+        INTENSITY_2,
+        EMITTER,
+        COUNT
+    };
+
     class Shader {
+        public:
+        unsigned int id;
+
         private:
+        static unsigned int lastId;
+
         unsigned int progPtr;
         unsigned int vertPtr;
         unsigned int fragPtr;
 
-        std::unordered_map<const char *, unsigned int> *uniforms;
-        std::unordered_map<const char *, unsigned int> *attributes;
+        int locations[(int)Uniform::COUNT];
+        std::vector<std::pair<std::string, int>> *uniforms;
+        std::vector<std::pair<std::string, int>> *attributes;
 
         public:
         Shader(const char *, const char *);
         Shader(const char **, const char **);
         ~Shader();
 
+        int uniform(Uniform);
         unsigned int uniformLoc(const char *);
         unsigned int attributeLoc(const char *);
         void bind();
 
         private:
         unsigned int createShader(int, const char**);
+        void reflect();
         void logProgram();
         void logShader(unsigned int);
     };
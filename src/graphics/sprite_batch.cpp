@@ -1,6 +1,5 @@
 #include <SDL.h>
 #include <stdexcept>
-#include <glm/gtc/type_ptr.hpp>
 
 #include "sprite_batch.h"
 #include "../app.h"
@@ -10,15 +9,21 @@ static constexpr const char *DEFAULT_VERTEX_SHADER = R"(
 #version 150 core
 
 in vec2 a_position;
-in vec2 a_tex_coords_0;
+in vec3 a_tex_coords_0;
 in vec4 a_color;
 in vec4 a_tint;
 
-out vec2 v_tex_coords;
+out vec3 v_tex_coords;
 out vec4 v_color;
 out vec4 v_tint;
 
-uniform mat4 u_proj;
+layout(std140) uniform Frame {
+    mat4 u_proj;
+    vec2 u_resolution;
+    vec2 u_camera;
+    vec2 u_zoom;
+    float u_time;
+};
 
 void main() {
     gl_Position = u_proj * vec4(a_position, 1.0, 1.0);
@@ -27,57 +32,73 @@ void main() {
     v_tint = a_tint;
 })";
 
+// Positions are half floats relative to the camera, so the frame block's camera is the batch origin.
+static constexpr const char *COMPACT_VERTEX_SHADER = R"(
+#version 150 core
+
+in vec2 a_position;
+in vec2 a_tex_coords_0;
+in uint a_layer;
+in vec4 a_color;
+in vec4 a_tint;
+
+out vec3 v_tex_coords;
+out vec4 v_color;
+out vec4 v_tint;
+
+layout(std140) uniform Frame {
+    mat4 u_proj;
+    vec2 u_resolution;
+    vec2 u_camera;
+    vec2 u_zoom;
+    float u_time;
+};
+
+void main() {
+    gl_Position = u_proj * vec4(a_position + u_camera, 1.0, 1.0);
+    v_tex_coords = vec3(a_tex_coords_0, float(a_layer));
+    v_color = a_color;
+    v_tint = a_tint;
+})";
+
 static constexpr const char *DEFAULT_FRAGMENT_SHADER = R"(
 #version 150 core
 
 out vec4 fragColor;
 
-in vec2 v_tex_coords;
+in vec3 v_tex_coords;
 in vec4 v_color;
 in vec4 v_tint;
 
 uniform sampler2D u_texture;
 
 void main() {
-    vec4 base = texture2D(u_texture, v_tex_coords);
+    vec4 base = texture2D(u_texture, v_tex_coords.xy);
     gl_FragColor = v_color * mix(base, vec4(v_tint.rgb, base.a), v_tint.a);
 })";
 
-namespace Fantasy {
-    SpriteBatch::SpriteBatch(): SpriteBatch(8191, nullptr) {}
-    SpriteBatch::SpriteBatch(size_t size, Shader *shader) {
-        if(size > 8191) throw std::runtime_error("Max vertices is 8191");
+static constexpr const char *ARRAY_FRAGMENT_SHADER = R"(
+#version 150 core
 
-        color = Color::white;
-        colorBits = color.fabgr();
-        tinted = Color();
-        tintBits = tinted.fabgr();
-        index = 0;
-        texture = nullptr;
-        projection = glm::identity<glm::mat4>();
+out vec4 fragColor;
 
-        size_t indicesCount = size * 6;
-        mesh = new Mesh(size * 4, indicesCount, 4, new VertexAttr[4]{
-            VertexAttr::position2D,
-            VertexAttr::color,
-            VertexAttr::tint,
-            VertexAttr::texCoords
-        });
+in vec3 v_tex_coords;
+in vec4 v_color;
+in vec4 v_tint;
 
-        spriteSize = 4 * ( // Vertex size.
-            2 + // Position.
-            1 + // Base color.
-            1 + // Tint color.
-            2   // Texture coordinates.
-        );
+uniform sampler2DArray u_texture;
 
-        vertLength = size * spriteSize;
-        vertices = new float[vertLength];
-        tmp = new float[spriteSize * 4];
+void main() {
+    vec4 base = texture(u_texture, v_tex_coords);
+    gl_FragColor = v_color * mix(base, vec4(v_tint.rgb, base.a), v_tint.a);
+})";
 
-        this->shader = shader == nullptr ? new Shader(DEFAULT_VERTEX_SHADER, DEFAULT_FRAGMENT_SHADER) : shader;
+namespace Fantasy {
+    const char *const SpriteBatch::fragmentSource = DEFAULT_FRAGMENT_SHADER;
+    const char *const SpriteBatch::arrayFragmentSource = ARRAY_FRAGMENT_SHADER;
 
-        unsigned short *indices = new unsigned short[indicesCount];
+    template<typename T>
+    static void writeIndices(Mesh *mesh, T *indices, size_t indicesCount) {
         for(size_t i = 0, j = 0; i < indicesCount; i += 6, j += 4) {
             indices[i] = j;
             indices[i + 1] = j + 1;
@@ -86,45 +107,131 @@ namespace Fantasy {
             indices[i + 4] = j + 3;
             indices[i + 5] = j;
         }
+
         mesh->setIndices(indices, 0, indicesCount);
         delete[] indices;
     }
 
+    static void writeCompactSprites(float *, const SpriteInstance *, size_t);
+
+    static const SpriteFormat vertexLayout = {
+        4 * ( // Vertex size.
+            2 + // Position.
+            1 + // Base color.
+            1 + // Tint color.
+            3   // Texture coordinates and array layer.
+        ),
+        writeSprites
+    };
+
+    static const SpriteFormat compactLayout = {
+        4 * ( // Vertex size.
+            1 + // Position as two half floats.
+            1 + // Texture coordinates as two normalized shorts.
+            1 + // Base color.
+            1 + // Tint color.
+            1   // Array layer.
+        ),
+        writeCompactSprites
+    };
+
+    SpriteFormat SpriteBatch::vertexFormat(bool compact) {
+        return compact ? compactLayout : vertexLayout;
+    }
+
+    // Room for `size` sprites in the vertex layout, with the quad indices already written.
+    Mesh *SpriteBatch::createMesh(size_t size, bool streaming, bool compact) {
+        if(size > 1048576) throw std::runtime_error("Max sprites is 1048576");
+        if(size == 0) return nullptr;
+
+        size_t indicesCount = size * 6;
+        Mesh *mesh = compact ? new Mesh(size * 4, indicesCount, 5, new VertexAttr[5]{
+            VertexAttr::positionHalf,
+            VertexAttr::texCoordsPacked,
+            VertexAttr::color,
+            VertexAttr::tint,
+            VertexAttr::layer
+        }, streaming) : new Mesh(size * 4, indicesCount, 4, new VertexAttr[4]{
+            VertexAttr::position2D,
+            VertexAttr::color,
+            VertexAttr::tint,
+            VertexAttr::texCoordsLayered
+        }, streaming);
+
+        // Batches past 16-bit vertex indices switch to 32-bit ones instead of flushing more often.
+        if(size * 4 <= 65536) {
+            writeIndices(mesh, new unsigned short[indicesCount], indicesCount);
+        } else {
+            writeIndices(mesh, new unsigned int[indicesCount], indicesCount);
+        }
+
+        return mesh;
+    }
+
+    SpriteBatch::SpriteBatch(): SpriteBatch(32768, nullptr) {}
+    // A zero sized batch owns no GL objects, for subclasses that keep vertices on the CPU.
+    SpriteBatch::SpriteBatch(size_t size, Shader *shader, bool compact): SpriteBatch(
+        vertexFormat(compact), size, createMesh(size, true, compact),
+        size == 0 ? nullptr : shader == nullptr ? createShader(false, compact) : shader,
+        size == 0 ? nullptr : createShader(true, compact)
+    ) {}
+
+    Shader *SpriteBatch::createShader(bool layered, bool compact) {
+        return createShader(compact ? COMPACT_VERTEX_SHADER : DEFAULT_VERTEX_SHADER, layered);
+    }
+
+    // Any vertex shader handing over v_tex_coords, v_color and v_tint can share the sprite fragment shaders.
+    Shader *SpriteBatch::createShader(const char *vertexSource, bool layered) {
+        Shader *shader = new Shader(vertexSource, layered ? ARRAY_FRAGMENT_SHADER : DEFAULT_FRAGMENT_SHADER);
+        shader->bind();
+        glUniform1i(shader->uniform(Uniform::TEXTURE), 0);
+
+        return shader;
+    }
+
+    SpriteBatch::SpriteBatch(const SpriteFormat &format, size_t size, Mesh *mesh, Shader *shader, Shader *arrayShader) {
+        color = Color::white;
+        colorBits = color.abgr();
+        tinted = Color();
+        tintBits = tinted.abgr();
+        index = 0;
+        window = 0;
+        vertices = nullptr;
+        texture = nullptr;
+
+        spriteSize = format.size;
+        writer = format.write;
+        vertLength = size * spriteSize;
+
+        this->mesh = mesh;
+        this->shader = shader;
+        this->arrayShader = arrayShader;
+
+        // Textures always go to unit 0, so the samplers are set once here instead of on every flush.
+        for(Shader *program : {shader, arrayShader}) {
+            if(program == nullptr) continue;
+
+            program->bind();
+            glUniform1i(program->uniform(Uniform::TEXTURE), 0);
+        }
+    }
+
     SpriteBatch::~SpriteBatch() {
         if(shader != nullptr) delete shader;
+        if(arrayShader != nullptr) delete arrayShader;
         if(mesh != nullptr) delete mesh;
-        if(vertices != nullptr) delete[] vertices;
     }
 
     void SpriteBatch::draw(Tex2D *texture, float *vertices, size_t offset, size_t length) {
         if(length % spriteSize != 0) throw std::runtime_error(std::string("Vertices size must be increment of ").append(std::to_string(spriteSize)).c_str());
 
-        int len = vertLength;
-        int remaining = len;
-        if(this->texture != texture) {
-            flush();
-            this->texture = texture;
-        } else {
-            remaining -= index;
-            if(remaining == 0) {
-                flush();
-                remaining = len;
-            }
-        }
-
-        size_t copyCount = fminf(remaining, length);
-
-        SDL_memcpy(this->vertices + index, vertices + offset, copyCount * sizeof(float));
-        index += copyCount;
-        length -= copyCount;
         while(length > 0) {
-            offset += copyCount;
-            flush();
+            size_t count = length / spriteSize;
+            float *out = reserve(texture, count);
 
-            copyCount = fminf(len, length);
-            SDL_memcpy(this->vertices, vertices + offset, copyCount * sizeof(float));
-            index += copyCount;
-            length -= copyCount;
+            SDL_memcpy(out, vertices + offset, count * spriteSize * sizeof(float));
+            offset += count * spriteSize;
+            length -= count * spriteSize;
         }
     }
 
@@ -137,77 +244,137 @@ namespace Fantasy {
     }
 
     void SpriteBatch::draw(const TexRegion &region, float x, float y, float originX, float originY, float width, float height, float rotation) {
-        glm::mat4 trns = glm::rotate(glm::identity<glm::mat4>(), rotation, glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::vec2
-            pos1 = trns * glm::vec4(originX - x, originY - y, 0.0f, 1.0f),
-            pos2 = trns * glm::vec4(originX - x + width, originY - y, 0.0f, 1.0f),
-            pos3 = trns * glm::vec4(originX - x + width, originY - y + height, 0.0f, 1.0f),
-            pos4 = trns * glm::vec4(originX - x, originY - y + height, 0.0f, 1.0f);
-
-        tmp[0] = pos1.x + x;
-        tmp[1] = pos1.y + y;
-        tmp[2] = colorBits;
-        tmp[3] = tintBits;
-        tmp[4] = region.u;
-        tmp[5] = region.v;
-
-        tmp[6] = pos2.x + x;
-        tmp[7] = pos2.y + y;
-        tmp[8] = colorBits;
-        tmp[9] = tintBits;
-        tmp[10] = region.u2;
-        tmp[11] = region.v;
-
-        tmp[12] = pos3.x + x;
-        tmp[13] = pos3.y + y;
-        tmp[14] = colorBits;
-        tmp[15] = tintBits;
-        tmp[16] = region.u2;
-        tmp[17] = region.v2;
-
-        tmp[18] = pos4.x + x;
-        tmp[19] = pos4.y + y;
-        tmp[20] = colorBits;
-        tmp[21] = tintBits;
-        tmp[22] = region.u;
-        tmp[23] = region.v2;
-
-        draw(region.texture, tmp, 0, 24);
+        SpriteInstance sprite;
+        sprite.region = &region;
+        sprite.x = x;
+        sprite.y = y;
+        sprite.originX = originX - x;
+        sprite.originY = originY - y;
+        sprite.width = width;
+        sprite.height = height;
+        sprite.sin = rotation == 0.0f ? 0.0f : sinf(rotation);
+        sprite.cos = rotation == 0.0f ? 1.0f : cosf(rotation);
+        sprite.color = colorBits;
+        sprite.tint = tintBits;
+
+        draw(&sprite, 1);
+    }
+
+    static inline unsigned int packUnit(float u, float v) {
+        unsigned int pu = (unsigned int)(Mathf::clamp(u) * 65535.0f + 0.5f);
+        unsigned int pv = (unsigned int)(Mathf::clamp(v) * 65535.0f + 0.5f);
+        return pu | pv << 16;
+    }
+
+    static void writeCompactSprites(float *out, const SpriteInstance *sprites, size_t count) {
+        glm::vec2 origin = App::iuniforms().camera();
+
+        for(size_t i = 0; i < count; i++) {
+            const SpriteInstance &sprite = sprites[i];
+            const TexRegion &region = *sprite.region;
+
+            // Corners are computed in full precision, then rebased on the origin before being rounded to halves.
+            float full[7 * 4];
+            SpriteInstance rebased = sprite;
+            rebased.x -= origin.x;
+            rebased.y -= origin.y;
+            writeSprite(full, rebased);
+
+            unsigned int uvs[4] = {
+                packUnit(region.u, region.v), packUnit(region.u2, region.v),
+                packUnit(region.u2, region.v2), packUnit(region.u, region.v2)
+            };
+
+            for(int j = 0; j < 4; j++, out += 5) {
+                writeBits(out, Mathf::half(full[j * 7]) | (unsigned int)Mathf::half(full[j * 7 + 1]) << 16);
+                writeBits(out + 1, uvs[j]);
+                writeBits(out + 2, sprite.color);
+                writeBits(out + 3, sprite.tint);
+                writeBits(out + 4, (unsigned int)region.layer);
+            }
+        }
+    }
+
+    void SpriteBatch::draw(const SpriteInstance *sprites, size_t count) {
+        for(size_t i = 0; i < count;) {
+            Tex2D *texture = sprites[i].region->texture;
+
+            size_t run = 1;
+            while(i + run < count && sprites[i + run].region->texture == texture) run++;
+
+            float *out = reserve(texture, run);
+            writer(out, sprites + i, run);
+
+            i += run;
+        }
+    }
+
+    float *SpriteBatch::reserve(Tex2D *texture, size_t &count) {
+        if(this->texture != texture) {
+            flush();
+            this->texture = texture;
+        } else if(index == window) {
+            flush();
+        }
+
+        // Sprites are written straight into the mapped stream buffer; a window that can't take at least an
+        // eighth of the batch moves on to the next ring region.
+        if(vertices == nullptr) vertices = mesh->map(vertLength / 8, vertLength, window);
+
+        size_t fit = (window - index) / spriteSize;
+        if(count > fit) count = fit;
+
+        float *out = vertices + index;
+        index += count * spriteSize;
+        return out;
     }
 
     void SpriteBatch::col(const Color &color) {
         this->color = color;
-        colorBits = color.fabgr();
+        colorBits = color.abgr();
     }
 
-    void SpriteBatch::col(float abgr) {
-        color.fromFagbr(abgr);
+    void SpriteBatch::col(unsigned int abgr) {
+        color.fromAbgr(abgr);
         this->colorBits = abgr;
     }
 
     void SpriteBatch::tint(const Color &color) {
         this->tinted = color;
-        tintBits = color.fabgr();
+        tintBits = color.abgr();
     }
 
-    void SpriteBatch::tint(float abgr) {
-        tinted.fromFagbr(abgr);
+    void SpriteBatch::tint(unsigned int abgr) {
+        tinted.fromAbgr(abgr);
         this->tintBits = abgr;
     }
 
     void SpriteBatch::proj(const glm::mat4 &projection) {
-        this->projection = projection;
+        App::iuniforms().proj(projection);
     }
 
     void SpriteBatch::flush() {
-        if(index == 0 || texture == nullptr) return;
+        if(vertices == nullptr) return;
 
-        shader->bind();
-        glUniformMatrix4fv(shader->uniformLoc("u_proj"), 1, false, glm::value_ptr(projection));
-        glUniform1i(shader->uniformLoc("u_texture"), texture->active(0));
-        
-        mesh->setVertices(vertices, 0, index);
-        mesh->render(shader, GL_TRIANGLES, 0, index / spriteSize * 6);
+        mesh->unmap(index);
+        vertices = nullptr;
+        window = 0;
+        if(index == 0) return;
+
+        Shader *program = texture->layered() ? arrayShader : shader;
+        program->bind();
+        App::iuniforms().upload();
+        texture->active(0);
+
+        render(program, index / spriteSize);
         index = 0;
     }
+
+    void SpriteBatch::render(Shader *shader, size_t count) {
+        mesh->render(shader, GL_TRIANGLES, 0, count * 6);
+    }
+
+    SpriteFormat SpriteBatch::format() {
+        return {spriteSize, writer};
+    }
 }
@@ -4,47 +4,72 @@
 #include <glm/mat4x4.hpp>
 
 #include "mesh.h"
+#include "sprite_kernel.h"
 #include "tex.h"
 #include "tex_atlas.h"
 #include "color.h"
 
 namespace Fantasy {
+    // How a batch lays sprites out in its stream. Anything recorded for a batch has to use that batch's format.
+    struct SpriteFormat {
+        public:
+        size_t size;
+        void (*write)(float *, const SpriteInstance *, size_t);
+    };
+
     class SpriteBatch {
         protected:
         Tex2D *texture;
         Color color;
-        float colorBits;
+        unsigned int colorBits;
         Color tinted;
-        float tintBits;
+        unsigned int tintBits;
 
         size_t index;
         size_t spriteSize;
+        void (*writer)(float *, const SpriteInstance *, size_t);
 
         Mesh *mesh;
         Shader *shader;
+        Shader *arrayShader;
+
+        static const char *const fragmentSource;
+        static const char *const arrayFragmentSource;
 
         private:
         size_t vertLength;
+        size_t window;
         float *vertices;
-        float *tmp;
-        glm::mat4 projection;
 
         public:
         SpriteBatch();
-        SpriteBatch(size_t, Shader *);
-        ~SpriteBatch();
+        SpriteBatch(size_t, Shader *, bool compact = false);
+        virtual ~SpriteBatch();
         
-        void draw(Tex2D *, float *, size_t, size_t);
+        virtual void draw(Tex2D *, float *, size_t, size_t);
+        void draw(const SpriteInstance *, size_t);
         void draw(const TexRegion &, float, float, float rotation = 0.0f);
         void draw(const TexRegion &, float, float, float, float, float rotation = 0.0f);
         void draw(const TexRegion &, float, float, float, float, float, float, float rotation = 0.0f);
         void col(const Color &);
-        void col(float);
+        void col(unsigned int);
         void tint(const Color &);
-        void tint(float);
+        void tint(unsigned int);
 
         void proj(const glm::mat4 &projection);
-        void flush();
+        virtual void flush();
+        SpriteFormat format();
+
+        static SpriteFormat vertexFormat(bool compact = false);
+        static Mesh *createMesh(size_t, bool streaming = true, bool compact = false);
+        static Shader *createShader(bool, bool compact = false);
+        static Shader *createShader(const char *, bool);
+
+        protected:
+        SpriteBatch(const SpriteFormat &, size_t, Mesh *, Shader *, Shader *);
+
+        virtual float *reserve(Tex2D *, size_t &);
+        virtual void render(Shader *, size_t);
     };
 }
 
@@ -0,0 +1,83 @@
+#ifndef SPRITE_KERNEL_H
+#define SPRITE_KERNEL_H
+
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FANTASY_SSE
+#endif
+
+#include "tex_atlas.h"
+
+namespace Fantasy {
+    // Origin is the unrotated bottom left corner relative to the position, which is also the pivot.
+    struct SpriteInstance {
+        public:
+        const TexRegion *region;
+        float x, y, originX, originY, width, height;
+        float sin, cos;
+        unsigned int color, tint;
+    };
+
+    // Streams are addressed in 32 bit words; packed integers are copied in bit for bit, never through a float.
+    inline void writeBits(float *out, unsigned int bits) {
+        std::memcpy(out, &bits, sizeof(bits));
+    }
+
+    // Writes a sprite as four full vertices of position, color, tint, texture coordinates and layer. Kept apart from
+    // the batch so it can be measured without a GL context.
+    inline void writeSprite(float *out, const SpriteInstance &sprite) {
+        const TexRegion &region = *sprite.region;
+        float cx[4], cy[4];
+
+#ifdef FANTASY_SSE
+        __m128 dx = _mm_setr_ps(sprite.originX, sprite.originX + sprite.width, sprite.originX + sprite.width, sprite.originX);
+        __m128 dy = _mm_setr_ps(sprite.originY, sprite.originY, sprite.originY + sprite.height, sprite.originY + sprite.height);
+        __m128 x = _mm_set1_ps(sprite.x), y = _mm_set1_ps(sprite.y);
+
+        if(sprite.sin == 0.0f && sprite.cos == 1.0f) {
+            _mm_storeu_ps(cx, _mm_add_ps(x, dx));
+            _mm_storeu_ps(cy, _mm_add_ps(y, dy));
+        } else {
+            __m128 sin = _mm_set1_ps(sprite.sin), cos = _mm_set1_ps(sprite.cos);
+            _mm_storeu_ps(cx, _mm_add_ps(x, _mm_sub_ps(_mm_mul_ps(dx, cos), _mm_mul_ps(dy, sin))));
+            _mm_storeu_ps(cy, _mm_add_ps(y, _mm_add_ps(_mm_mul_ps(dx, sin), _mm_mul_ps(dy, cos))));
+        }
+#else
+        float dx[4] = {sprite.originX, sprite.originX + sprite.width, sprite.originX + sprite.width, sprite.originX};
+        float dy[4] = {sprite.originY, sprite.originY, sprite.originY + sprite.height, sprite.originY + sprite.height};
+
+        if(sprite.sin == 0.0f && sprite.cos == 1.0f) {
+            for(int i = 0; i < 4; i++) {
+                cx[i] = sprite.x + dx[i];
+                cy[i] = sprite.y + dy[i];
+            }
+        } else {
+            for(int i = 0; i < 4; i++) {
+                cx[i] = sprite.x + dx[i] * sprite.cos - dy[i] * sprite.sin;
+                cy[i] = sprite.y + dx[i] * sprite.sin + dy[i] * sprite.cos;
+            }
+        }
+#endif
+
+        float us[4] = {region.u, region.u2, region.u2, region.u};
+        float vs[4] = {region.v, region.v, region.v2, region.v2};
+        for(int i = 0; i < 4; i++, out += 7) {
+            out[0] = cx[i];
+            out[1] = cy[i];
+            writeBits(out + 2, sprite.color);
+            writeBits(out + 3, sprite.tint);
+            out[4] = us[i];
+            out[5] = vs[i];
+            out[6] = region.layer;
+        }
+    }
+
+    inline void writeSprites(float *out, const SpriteInstance *sprites, size_t count) {
+        for(size_t i = 0; i < count; i++, out += 4 * 7) writeSprite(out, sprites[i]);
+    }
+}
+
+#endif
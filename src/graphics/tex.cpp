@@ -2,8 +2,10 @@
 #include <cmath>
 #include <string>
 #include <exception>
+#include <stdexcept>
 
 #include "tex.h"
+#include "gl_state.h"
 #include "../app.h"
 
 namespace Fantasy {
@@ -14,6 +16,7 @@ namespace Fantasy {
     }
 
     Tex::~Tex() {
+        GLState::forgetTexture(data);
         glDeleteTextures(1, &data);
     }
 
@@ -28,9 +31,7 @@ namespace Fantasy {
     }
 
     int Tex::active(int unit) {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        bind();
-
+        GLState::bindTexture(unit, target(), data);
         return unit;
     }
 
@@ -42,7 +43,11 @@ namespace Fantasy {
     }
 
     void Tex2D::bind() {
-        glBindTexture(GL_TEXTURE_2D, data);
+        GLState::bindTexture(GL_TEXTURE_2D, data);
+    }
+
+    unsigned int Tex2D::target() {
+        return GL_TEXTURE_2D;
     }
 
     void Tex2D::set(SDL_Surface *surface, bool bind) {
@@ -65,7 +70,8 @@ namespace Fantasy {
             GL_UNSIGNED_BYTE, substitute != nullptr ? substitute->pixels : surface != nullptr ? surface->pixels : nullptr
         );
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+        // Empty storage is a render target, which never samples from mipmaps.
+        if(surface != nullptr) glGenerateMipmap(GL_TEXTURE_2D);
         if(substitute != nullptr) SDL_FreeSurface(substitute);
     }
 
@@ -80,4 +86,73 @@ namespace Fantasy {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag);
     }
+
+    TexArray::TexArray(int width, int height, std::vector<SDL_Surface *> *layers): Tex2D(width, height, nullptr) {
+        this->layers = layers;
+        depth = layers->size();
+    }
+
+    TexArray::~TexArray() {
+        if(layers != nullptr) {
+            for(SDL_Surface *layer : *layers) SDL_FreeSurface(layer);
+            delete layers;
+        }
+    }
+
+    void TexArray::bind() {
+        GLState::bindTexture(GL_TEXTURE_2D_ARRAY, data);
+    }
+
+    unsigned int TexArray::target() {
+        return GL_TEXTURE_2D_ARRAY;
+    }
+
+    void TexArray::set(SDL_Surface *surface, bool bind) {
+        if(layers == nullptr) return;
+
+        int maxLayers;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        if(depth > maxLayers) throw std::runtime_error(std::string("Texture array has ").append(std::to_string(depth)).append(" layers, the maximum is ").append(std::to_string(maxLayers)).append("."));
+
+        if(bind) this->bind();
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, depth, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        for(int i = 0; i < depth; i++) {
+            SDL_Surface *layer = layers->at(i), *substitute = nullptr;
+            if(layer->w > width || layer->h > height) throw std::runtime_error("Texture array layer is larger than the array.");
+
+            if(layer->format->format != SDL_PIXELFORMAT_ABGR8888) substitute = SDL_ConvertSurfaceFormat(layer, SDL_PIXELFORMAT_ABGR8888, 0);
+            glTexSubImage3D(
+                GL_TEXTURE_2D_ARRAY, 0,
+                0, 0, i,
+                layer->w, layer->h, 1,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE, substitute != nullptr ? substitute->pixels : layer->pixels
+            );
+
+            if(substitute != nullptr) SDL_FreeSurface(substitute);
+            SDL_FreeSurface(layer);
+        }
+
+        delete layers;
+        layers = nullptr;
+
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+
+    void TexArray::setWrap(int s, int t, int r, bool bind) {
+        if(bind) this->bind();
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, s);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, t);
+    }
+
+    void TexArray::setFilter(int min, int mag, bool bind) {
+        if(bind) this->bind();
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, min);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, mag);
+    }
+
+    bool TexArray::layered() {
+        return true;
+    }
 }
@@ -3,6 +3,7 @@
 
 #include <SDL_image.h>
 #include <GL/glew.h>
+#include <vector>
 
 namespace Fantasy {
     class Tex {
@@ -13,7 +14,7 @@ namespace Fantasy {
         public:
         Tex(const char *);
         Tex(SDL_Surface *);
-        ~Tex();
+        virtual ~Tex();
 
         void load();
         virtual void bind() {}
@@ -21,6 +22,8 @@ namespace Fantasy {
         int active(int);
         virtual void setWrap(int, int, int, bool bind = true) {}
         virtual void setFilter(int, int, bool bind = true) {}
+        virtual bool layered() { return false; }
+        virtual unsigned int target() { return 0; }
     };
 
     class Tex2D: public Tex {
@@ -38,6 +41,27 @@ namespace Fantasy {
         virtual void set(SDL_Surface *, bool bind = true) override;
         void setWrap(int, int, int, bool bind = true) override;
         void setFilter(int, int, bool bind = true) override;
+        unsigned int target() override;
+    };
+
+    // Pages of equal or smaller size stacked as layers of one GL_TEXTURE_2D_ARRAY, each anchored at the top left.
+    class TexArray: public Tex2D {
+        public:
+        int depth;
+
+        private:
+        std::vector<SDL_Surface *> *layers;
+
+        public:
+        TexArray(int, int, std::vector<SDL_Surface *> *);
+        ~TexArray() override;
+
+        void bind() override;
+        void set(SDL_Surface *, bool bind = true) override;
+        void setWrap(int, int, int, bool bind = true) override;
+        void setFilter(int, int, bool bind = true) override;
+        bool layered() override;
+        unsigned int target() override;
     };
 }
 
@@ -5,30 +5,10 @@
 #include "tex_atlas.h"
 
 namespace Fantasy {
-    TexRegion::TexRegion(): TexRegion(nullptr, 0, 0, 1, 1) {}
-    TexRegion::TexRegion(Tex2D *texture): TexRegion(texture, 0, 0, texture->width, texture->height) {}
-    TexRegion::TexRegion(Tex2D *texture, int x, int y, int width, int height) {
-        this->texture = texture;
-        this->x = x;
-        this->y = y;
-        this->width = width;
-        this->height = height;
-
-        if(texture == nullptr) {
-            u = v2 = 0.0f;
-            u2 = v = 1.0f;
-        } else {
-            u = (float)x / (float)texture->width;
-            v2 = (float)y / (float)texture->height;
-            u2 = (float)(x + width) / (float)texture->width;
-            v = (float)(y + height) / (float)texture->height;
-        }
-    }
-
-    TexAtlas::TexAtlas() {}
+    TexAtlas::TexAtlas(): regions(1) {}
     TexAtlas::TexAtlas(const std::string &filename): TexAtlas(filename, (std::istream &&)std::move(std::ifstream(filename, std::ios::binary))) {}
     TexAtlas::TexAtlas(const std::string &filename, const std::istream &stream): TexAtlas(filename, (std::istream &&)std::move(stream)) {}
-    TexAtlas::TexAtlas(const std::string &filename, std::istream &&stream) {
+    TexAtlas::TexAtlas(const std::string &filename, std::istream &&stream): regions(1) {
         char version;
         stream >> version;
 
@@ -39,6 +19,16 @@ namespace Fantasy {
         
         switch(version) {
             case 1: {
+                struct PageRegion {
+                    std::string name;
+                    int x, y, width, height;
+                    int page;
+                };
+
+                std::vector<SDL_Surface *> *pages = new std::vector<SDL_Surface *>();
+                std::vector<PageRegion> pageRegions;
+                int width = 0, height = 0;
+
                 size_t pageSize;
                 stream.read(reinterpret_cast<char *>(&pageSize), sizeof(size_t));
 
@@ -50,11 +40,17 @@ namespace Fantasy {
                     stream.read(pageName, pageNameSize);
                     pageName[pageNameSize] = '\0';
 
-                    Tex2D *pageTex = new Tex2D(std::string(prefix).append(pageName).c_str());
-                    pageTex->load();
-                    pageTex->setFilter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
-                    pageTex->setWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
-                    textures.emplace(pageTex);
+                    SDL_Surface *surface = IMG_Load(std::string(prefix).append(pageName).c_str());
+                    if(surface == nullptr) {
+                        for(SDL_Surface *other : *pages) SDL_FreeSurface(other);
+                        delete pages;
+
+                        throw std::runtime_error(std::string("Couldn't load atlas page '").append(pageName).append("'."));
+                    }
+
+                    pages->push_back(surface);
+                    if(surface->w > width) width = surface->w;
+                    if(surface->h > height) height = surface->h;
 
                     size_t regSize;
                     stream.read(reinterpret_cast<char *>(&regSize), sizeof(size_t));
@@ -73,9 +69,23 @@ namespace Fantasy {
                             .read(reinterpret_cast<char *>(&width), sizeof(int))
                             .read(reinterpret_cast<char *>(&height), sizeof(int));
 
-                        regions.emplace(std::string(regName), TexRegion(pageTex, x, y, width, height));
+                        pageRegions.push_back({std::string(regName), x, y, width, height, (int)page});
                     }
                 }
+
+                // Every page goes into one array texture so sprites from different pages still batch together.
+                TexArray *pageTex = new TexArray(width, height, pages);
+                pageTex->load();
+                pageTex->setFilter(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST);
+                pageTex->setWrap(GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER, GL_CLAMP_TO_BORDER);
+                textures.emplace(pageTex);
+
+                for(const PageRegion &reg : pageRegions) {
+                    if(regions.size() > 0xffff) throw std::runtime_error("Too many texture regions.");
+
+                    names.emplace(reg.name, regions.size());
+                    regions.push_back(TexRegion(pageTex, reg.x, reg.y, reg.width, reg.height, reg.page));
+                }
             } break;
 
             default: throw std::runtime_error(std::string("Version ").append(std::to_string(version)).append(" not supported."));
@@ -87,7 +97,15 @@ namespace Fantasy {
     }
 
     const TexRegion &TexAtlas::get(const std::string &name) const {
-        if(!regions.count(name)) throw std::runtime_error(std::string("No such texture region: '").append(name).append("'."));
-        return regions.at(name);
+        return regions[find(name)];
+    }
+
+    const TexRegion &TexAtlas::get(RegionID id) const {
+        return regions[id];
+    }
+
+    RegionID TexAtlas::find(const std::string &name) const {
+        if(!names.count(name)) throw std::runtime_error(std::string("No such texture region: '").append(name).append("'."));
+        return names.at(name);
     }
 }
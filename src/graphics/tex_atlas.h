@@ -5,26 +5,31 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tex.h"
 
 namespace Fantasy {
+    typedef unsigned short RegionID;
+
     struct TexRegion {
         public:
         Tex2D *texture;
         int x, y, width, height;
         float u, v, u2, v2;
+        float layer;
 
         public:
         TexRegion();
         TexRegion(Tex2D *);
-        TexRegion(Tex2D *, int, int, int, int);
+        TexRegion(Tex2D *, int, int, int, int, int layer = 0);
     };
 
     class TexAtlas {
         private:
         std::unordered_set<Tex *> textures;
-        std::unordered_map<std::string, TexRegion> regions;
+        std::vector<TexRegion> regions;
+        std::unordered_map<std::string, RegionID> names;
 
         public:
         TexAtlas();
@@ -34,6 +39,8 @@ namespace Fantasy {
         ~TexAtlas();
 
         const TexRegion &get(const std::string &) const;
+        const TexRegion &get(RegionID) const;
+        RegionID find(const std::string &) const;
     };
 }
 
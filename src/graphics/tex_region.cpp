@@ -0,0 +1,24 @@
+#include "tex_atlas.h"
+
+namespace Fantasy {
+    TexRegion::TexRegion(): TexRegion(nullptr, 0, 0, 1, 1) {}
+    TexRegion::TexRegion(Tex2D *texture): TexRegion(texture, 0, 0, texture->width, texture->height) {}
+    TexRegion::TexRegion(Tex2D *texture, int x, int y, int width, int height, int layer) {
+        this->texture = texture;
+        this->layer = layer;
+        this->x = x;
+        this->y = y;
+        this->width = width;
+        this->height = height;
+
+        if(texture == nullptr) {
+            u = v2 = 0.0f;
+            u2 = v = 1.0f;
+        } else {
+            u = (float)x / (float)texture->width;
+            v2 = (float)y / (float)texture->height;
+            u2 = (float)(x + width) / (float)texture->width;
+            v = (float)(y + height) / (float)texture->height;
+        }
+    }
+}
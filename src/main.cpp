@@ -1,6 +1,8 @@
 #include <SDL.h>
 #include <SDL_main.h>
 #include <stdexcept>
+#include <cstdlib>
+#include <cstring>
 #include <glm/gtx/vector_angle.hpp>
 
 #include "app.h"
@@ -14,6 +16,17 @@ int main(int argc, char *argv[]) {
     config.width = 800;
     config.height = 600;
 
+    // --threads 0 runs every job on the main thread, handy for checking determinism.
+    for(int i = 1; i < argc - 1; i++) {
+        if(std::strcmp(argv[i], "--threads") == 0) config.threads = std::atoi(argv[++i]);
+        else if(std::strcmp(argv[i], "--bloom") == 0) config.bloom = Bloom::parse(argv[++i]);
+    }
+
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "--instanced") == 0) config.instanced = true;
+        else if(std::strcmp(argv[i], "--compact") == 0) config.compact = true;
+    }
+
     App *app;
     try {
         app = new App(argc, argv, config);
@@ -0,0 +1,44 @@
+#ifndef B2_USER_SETTINGS_H
+#define B2_USER_SETTINGS_H
+
+// Picked up by Box2D when both it and the game are compiled with B2_USER_SETTINGS; see FANTASY_BOX2D_USER_SETTINGS.
+// Mirrors Box2D's defaults, except that b2Alloc and b2Free are counted by the game. Bodies, fixtures, shapes and
+// contacts never reach them: b2BlockAllocator carves those out of its own 16 KiB chunks, and only those chunks, the
+// stack allocator and the tree and contact buffers come through here.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define b2_lengthUnitsPerMeter 1.0f
+#define b2_maxPolygonVertices 8
+
+struct B2_API b2BodyUserData {
+    b2BodyUserData() { pointer = 0; }
+    uintptr_t pointer;
+};
+
+struct B2_API b2FixtureUserData {
+    b2FixtureUserData() { pointer = 0; }
+    uintptr_t pointer;
+};
+
+struct B2_API b2JointUserData {
+    b2JointUserData() { pointer = 0; }
+    uintptr_t pointer;
+};
+
+void *fantasyB2Alloc(int32_t);
+void fantasyB2Free(void *);
+
+inline void *b2Alloc(int32 size) { return fantasyB2Alloc(size); }
+inline void b2Free(void *mem) { fantasyB2Free(mem); }
+
+inline void b2Log(const char *string, ...) {
+    va_list args;
+    va_start(args, string);
+    vprintf(string, args);
+    va_end(args);
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include <SDL.h>
+#include <stdexcept>
+#include <string>
+
+#include "jobs.h"
+
+namespace Fantasy {
+    thread_local int Jobs::current = 0;
+
+    JobGroup::JobGroup(): pending(0) {}
+
+    Jobs::Jobs(int workerCount): queued(0), stopping(false) {
+        if(workerCount < 0) {
+            int cores = (int)std::thread::hardware_concurrency();
+            workerCount = cores > 1 ? cores - 1 : 0;
+        }
+
+        threads = new std::vector<std::thread>();
+        workers = new std::vector<Worker *>();
+        for(int i = 0; i <= workerCount; i++) workers->push_back(new Worker());
+        for(int i = 1; i <= workerCount; i++) threads->emplace_back(&Jobs::loop, this, i);
+
+        if(workerCount == 0) {
+            SDL_Log("Running jobs single-threaded.");
+        } else {
+            SDL_Log("Running jobs on %d worker threads.", workerCount);
+        }
+    }
+
+    Jobs::~Jobs() {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+
+        wake.notify_all();
+        for(std::thread &thread : *threads) thread.join();
+
+        for(Worker *worker : *workers) delete worker;
+        delete workers;
+        delete threads;
+    }
+
+    void Jobs::submit(const Job &job, JobGroup &group) {
+        group.pending.fetch_add(1);
+        Job wrapped = [this, job, &group]() {
+            try {
+                job();
+            } catch(...) {
+                std::lock_guard<std::mutex> guard(group.lock);
+                if(!group.error) group.error = std::current_exception();
+            }
+
+            // Waiters check the count under the sleep lock, so taking it here means the last job can't be missed.
+            if(group.pending.fetch_sub(1) == 1) {
+                {
+                    std::lock_guard<std::mutex> guard(sleepLock);
+                }
+                wake.notify_all();
+            }
+        };
+
+        if(isSerial()) {
+            wrapped();
+            return;
+        }
+
+        Worker *worker = workers->at(current);
+        {
+            std::lock_guard<std::mutex> guard(worker->lock);
+            worker->queue.push_back(std::move(wrapped));
+        }
+
+        queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wake.notify_one();
+    }
+
+    // Helps with whatever is queued, and sleeps until either more is queued or the group's last job is done.
+    void Jobs::wait(JobGroup &group) {
+        while(group.pending.load() > 0) {
+            if(runOne(current)) continue;
+
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this, &group]() { return group.pending.load() == 0 || queued.load() > 0; });
+        }
+
+        std::exception_ptr thrown;
+        {
+            std::lock_guard<std::mutex> guard(group.lock);
+            std::swap(thrown, group.error);
+        }
+
+        if(thrown) std::rethrow_exception(thrown);
+    }
+
+    int Jobs::threadCount() { return threads->size(); }
+    bool Jobs::isSerial() { return threads->empty(); }
+
+    bool Jobs::runOne(int self) {
+        Job job;
+        int count = workers->size();
+
+        // Own queue is LIFO for locality, other queues are stolen from the front.
+        for(int i = 0; i < count && !job; i++) {
+            Worker *worker = workers->at((self + i) % count);
+            std::lock_guard<std::mutex> guard(worker->lock);
+            if(worker->queue.empty()) continue;
+
+            if(i == 0) {
+                job = std::move(worker->queue.back());
+                worker->queue.pop_back();
+            } else {
+                job = std::move(worker->queue.front());
+                worker->queue.pop_front();
+            }
+        }
+
+        if(!job) return false;
+
+        queued.fetch_sub(1);
+        job();
+        return true;
+    }
+
+    void Jobs::loop(int index) {
+        current = index;
+        while(!stopping.load()) {
+            if(runOne(index)) continue;
+
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this]() { return stopping.load() || queued.load() > 0; });
+        }
+    }
+
+    TaskGraph::TaskGraph() {
+        tasks = new std::vector<Task *>();
+    }
+
+    TaskGraph::~TaskGraph() {
+        for(Task *task : *tasks) delete task;
+        delete tasks;
+    }
+
+    int TaskGraph::add(const char *name, const std::function<void()> &func, std::initializer_list<int> after) {
+        int index = tasks->size();
+        for(int dep : after) {
+            if(dep < 0 || dep >= index) throw std::runtime_error(std::string("Task '").append(name).append("' depends on a task that isn't added yet."));
+        }
+
+        Task *task = new Task();
+        task->name = name;
+        task->func = func;
+        task->dependencies = after.size();
+        task->remaining = 0;
+        tasks->push_back(task);
+
+        for(int dep : after) tasks->at(dep)->dependents.push_back(index);
+        return index;
+    }
+
+    void TaskGraph::run(Jobs &jobs) {
+        // Tasks can only depend on earlier ones, so insertion order is already a valid serial schedule.
+        if(jobs.isSerial()) {
+            for(Task *task : *tasks) task->func();
+            return;
+        }
+
+        for(Task *task : *tasks) task->remaining = task->dependencies;
+
+        JobGroup group;
+        for(size_t i = 0; i < tasks->size(); i++) {
+            if(tasks->at(i)->dependencies == 0) schedule(jobs, i, group);
+        }
+
+        jobs.wait(group);
+    }
+
+    void TaskGraph::log() {
+        for(Task *task : *tasks) {
+            std::string after;
+            for(Task *other : *tasks) {
+                for(int dep : other->dependents) {
+                    if(tasks->at(dep) == task) after.append(after.empty() ? "" : ", ").append(other->name);
+                }
+            }
+
+            SDL_Log("[task] %s%s%s", task->name, after.empty() ? "" : " after ", after.c_str());
+        }
+    }
+
+    void TaskGraph::schedule(Jobs &jobs, int index, JobGroup &group) {
+        jobs.submit([this, &jobs, index, &group]() {
+            Task *task = tasks->at(index);
+            task->func();
+
+            for(int dep : task->dependents) {
+                if(tasks->at(dep)->remaining.fetch_sub(1) == 1) schedule(jobs, dep, group);
+            }
+        }, group);
+    }
+}
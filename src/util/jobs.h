@@ -0,0 +1,115 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Fantasy {
+    // Jobs submitted against one group are waited on together. The first of them to throw has its exception rethrown by
+    // the wait, so errors never surface in an unrelated wait.
+    class JobGroup {
+        public:
+        std::atomic<int> pending;
+        std::mutex lock;
+        std::exception_ptr error;
+
+        public:
+        JobGroup();
+    };
+
+    class Jobs {
+        public:
+        typedef std::function<void()> Job;
+
+        private:
+        struct Worker {
+            std::mutex lock;
+            std::deque<Job> queue;
+        };
+
+        std::vector<std::thread> *threads;
+        std::vector<Worker *> *workers;
+
+        std::mutex sleepLock;
+        std::condition_variable wake;
+        std::atomic<int> queued;
+        std::atomic<bool> stopping;
+
+        static thread_local int current;
+
+        public:
+        Jobs(int);
+        ~Jobs();
+
+        void submit(const Job &, JobGroup &);
+        void wait(JobGroup &);
+        int threadCount();
+        bool isSerial();
+
+        template<typename F>
+        void parallelFor(size_t count, size_t grain, F &&func) {
+            if(grain == 0) grain = 1;
+            if(isSerial() || count <= grain) {
+                if(count > 0) func((size_t)0, count);
+                return;
+            }
+
+            JobGroup group;
+            for(size_t begin = 0; begin < count; begin += grain) {
+                size_t end = begin + grain < count ? begin + grain : count;
+                submit([&func, begin, end]() { func(begin, end); }, group);
+            }
+
+            wait(group);
+        }
+
+        // Works on any view whose iterators are random access, e.g. a single component EnTT view.
+        template<typename T, typename V, typename F>
+        void parallelEach(V &view, size_t grain, F &&func) {
+            auto begin = view.begin();
+            parallelFor(view.size(), grain, [&view, &func, begin](size_t from, size_t to) {
+                for(size_t i = from; i < to; i++) {
+                    auto e = begin[i];
+                    func(e, view.template get<T>(e));
+                }
+            });
+        }
+
+        private:
+        bool runOne(int);
+        void loop(int);
+    };
+
+    class TaskGraph {
+        private:
+        struct Task {
+            const char *name;
+            std::function<void()> func;
+            std::vector<int> dependents;
+            int dependencies;
+            std::atomic<int> remaining;
+        };
+
+        std::vector<Task *> *tasks;
+
+        public:
+        TaskGraph();
+        ~TaskGraph();
+
+        int add(const char *, const std::function<void()> &, std::initializer_list<int> after = {});
+        void run(Jobs &);
+        void log();
+
+        private:
+        void schedule(Jobs &, int, JobGroup &);
+    };
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <functional>
 #include <glm/gtx/transform.hpp>
 
@@ -18,31 +19,48 @@ namespace Fantasy {
 
         static inline float srandom(unsigned int seed) { return srandom(seed, 0.0f, 1.0f); }
         static inline float srandom(unsigned int seed, float mag) { return srandom(seed, 0.0f, mag); }
-        static inline float srandom(unsigned int seed, float from, float to) { srand(seed); return random(from, to); }
+        static inline float srandom(unsigned int seed, float from, float to) { return snext(seed, from, to); }
+
+        // Seeded randomness keeps its own state, since drawers run on several threads and rand() is shared.
+        static inline float snext(unsigned int &state, float from, float to) {
+            unsigned int x = (state += 0x9e3779b9u);
+            x ^= x >> 16;
+            x *= 0x7feb352du;
+            x ^= x >> 15;
+            x *= 0x846ca68bu;
+            x ^= x >> 16;
+
+            return from + ((float)x / 4294967295.0f) * (to - from);
+        }
 
         static inline float lerp(float from, float to, float progress) { return from + (to - from) * progress; }
 
-        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, const std::function<void(float, float)> &func) {
+        template<typename F>
+        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, F &&func) {
             randVecs(seed, amount, 0.0f, maxLength, progress, 0.0f, glm::two_pi<float>(), 0.0f, [](float len) { return 1.0f; }, func);
         }
 
-        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, float offsetAngle, const std::function<void(float, float)> &func) {
+        template<typename F>
+        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, float offsetAngle, F &&func) {
             randVecs(seed, amount, 0.0f, maxLength, progress, 0.0f, glm::two_pi<float>(), offsetAngle, [](float len) { return 1.0f; }, func);
         }
 
-        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, float offsetAngle, const std::function<float(float)> &angleProg, const std::function<void(float, float)> &func) {
+        template<typename A, typename F>
+        static inline void randVecs(unsigned int seed, int amount, float maxLength, float progress, float offsetAngle, A &&angleProg, F &&func) {
             randVecs(seed, amount, 0.0f, maxLength, progress, 0.0f, glm::two_pi<float>(), offsetAngle, angleProg, func);
         }
 
-        static inline void randVecs(unsigned int seed, int amount, float minLength, float maxLength, float progress, float offsetAngle, const std::function<float(float)> &angleProg, const std::function<void(float, float)> &func) {
+        template<typename A, typename F>
+        static inline void randVecs(unsigned int seed, int amount, float minLength, float maxLength, float progress, float offsetAngle, A &&angleProg, F &&func) {
             randVecs(seed, amount, minLength, maxLength, progress, 0.0f, glm::two_pi<float>(), offsetAngle, angleProg, func);
         }
 
-        static inline void randVecs(unsigned int seed, int amount, float minLength, float maxLength, float progress, float coneFrom, float coneTo, float offsetAngle, const std::function<float(float)> &angleProg, const std::function<void(float, float)> &func) {
-            srand(seed);
+        template<typename A, typename F>
+        static inline void randVecs(unsigned int seed, int amount, float minLength, float maxLength, float progress, float coneFrom, float coneTo, float offsetAngle, A &&angleProg, F &&func) {
+            unsigned int state = seed;
             for(int i = 0; i < amount; i++) {
-                float angle = random(coneFrom, coneTo);
-                float len = random(minLength, maxLength) * progress;
+                float angle = snext(state, coneFrom, coneTo);
+                float len = snext(state, minLength, maxLength) * progress;
                 
                 if(offsetAngle != 0.0f) angle += offsetAngle * angleProg(len);
                 float x = glm::cos(angle) * len;
@@ -51,6 +69,35 @@ namespace Fantasy {
             }
         }
 
+        // Rounds to the nearest IEEE half; out of range values become infinity, tiny ones denormals or zero.
+        static inline unsigned short half(float value) {
+            unsigned int bits;
+            memcpy(&bits, &value, sizeof(bits));
+
+            unsigned int sign = (bits >> 16) & 0x8000;
+            int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+            unsigned int mantissa = bits & 0x7fffff;
+
+            if(exponent <= 0) {
+                if(exponent < -10) return sign;
+
+                mantissa |= 0x800000;
+                int shift = 14 - exponent;
+                unsigned int result = mantissa >> shift;
+                if((mantissa >> (shift - 1)) & 1) result++;
+
+                return sign | result;
+            }
+
+            if(exponent >= 31) return sign | 0x7c00;
+
+            // A carry out of the mantissa correctly rounds up into the exponent.
+            unsigned int result = sign | (exponent << 10) | (mantissa >> 13);
+            if(mantissa & 0x1000) result++;
+
+            return result;
+        }
+
         static inline float clamp(float value) { return clamp(value, 0.0f, 1.0f); }
         static inline float clamp(float value, float min, float max) {
             if(min > value) return min;
@@ -0,0 +1,208 @@
+#include <SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "memory.h"
+
+static std::atomic<size_t> heapAllocations(0);
+static std::atomic<size_t> heapBytes(0);
+
+void *operator new(size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+
+    void *ptr = std::malloc(size == 0 ? 1 : size);
+    if(ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+
+// Box2D's allocation hooks, see b2_user_settings.h. What arrives is mostly block allocator chunks and growing buffers,
+// larger than any size class, so the slab mostly just accounts for them; only a few small initial buffers get slots.
+// The size is stashed in front of the block since b2Free doesn't pass it.
+void *fantasyB2Alloc(int32_t size) {
+    size_t total = (size_t)size + alignof(std::max_align_t);
+    char *ptr = static_cast<char *>(Fantasy::Memory::box2d().alloc(total));
+
+    *reinterpret_cast<size_t *>(ptr) = total;
+    return ptr + alignof(std::max_align_t);
+}
+
+void fantasyB2Free(void *mem) {
+    if(mem == nullptr) return;
+
+    char *ptr = static_cast<char *>(mem) - alignof(std::max_align_t);
+    Fantasy::Memory::box2d().free(ptr, *reinterpret_cast<size_t *>(ptr));
+}
+
+namespace Fantasy {
+    size_t Memory::allocations() {
+        return heapAllocations.load(std::memory_order_relaxed);
+    }
+
+    size_t Memory::allocatedBytes() {
+        return heapBytes.load(std::memory_order_relaxed);
+    }
+
+    SlabAllocator &Memory::box2d() {
+        static SlabAllocator allocator("box2d");
+        return allocator;
+    }
+
+    MemoryStats::MemoryStats(const char *name) {
+        this->name = name;
+        allocations = frees = 0;
+        bytes = peak = reserved = 0;
+    }
+
+    void MemoryStats::alloc(size_t size) {
+        allocations++;
+        bytes += size;
+        if(bytes > peak) peak = bytes;
+    }
+
+    void MemoryStats::free(size_t size) {
+        frees++;
+        bytes -= size;
+    }
+
+    float MemoryStats::fragmentation() const {
+        return reserved == 0 ? 0.0f : 1.0f - (float)bytes / (float)reserved;
+    }
+
+    void MemoryStats::log() const {
+        SDL_Log("[%s] %zu allocs, %zu frees, %zu bytes live (%zu peak), %zu reserved, %.1f%% fragmented.",
+            name, allocations, frees, bytes, peak, reserved, fragmentation() * 100.0f
+        );
+    }
+
+    const size_t SlabAllocator::classSizes[SlabAllocator::classCount] = {
+        16, 32, 64, 96, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640
+    };
+
+    SlabAllocator::SlabAllocator(const char *name): stats(name) {
+        for(int i = 0; i < classCount; i++) freeLists[i] = nullptr;
+        chunks = new std::vector<char *>();
+    }
+
+    SlabAllocator::~SlabAllocator() {
+        for(char *chunk : *chunks) std::free(chunk);
+        delete chunks;
+    }
+
+    int SlabAllocator::sizeClass(size_t size) {
+        for(int i = 0; i < classCount; i++) {
+            if(size <= classSizes[i]) return i;
+        }
+
+        return -1;
+    }
+
+    void *SlabAllocator::alloc(size_t size) {
+        stats.alloc(size);
+
+        int index = sizeClass(size);
+        if(index == -1) {
+            stats.reserved += size;
+            return std::malloc(size);
+        }
+
+        if(freeLists[index] == nullptr) {
+            char *chunk = static_cast<char *>(std::malloc(chunkSize));
+            chunks->push_back(chunk);
+            stats.reserved += chunkSize;
+
+            size_t slotSize = classSizes[index];
+            size_t count = chunkSize / slotSize;
+            for(size_t i = 0; i < count; i++) {
+                Slot *slot = reinterpret_cast<Slot *>(chunk + i * slotSize);
+                slot->next = i + 1 < count ? reinterpret_cast<Slot *>(chunk + (i + 1) * slotSize) : nullptr;
+            }
+
+            freeLists[index] = reinterpret_cast<Slot *>(chunk);
+        }
+
+        Slot *slot = freeLists[index];
+        freeLists[index] = slot->next;
+        return slot;
+    }
+
+    void SlabAllocator::free(void *ptr, size_t size) {
+        if(ptr == nullptr) return;
+        stats.free(size);
+
+        int index = sizeClass(size);
+        if(index == -1) {
+            stats.reserved -= size;
+            std::free(ptr);
+            return;
+        }
+
+        Slot *slot = static_cast<Slot *>(ptr);
+        slot->next = freeLists[index];
+        freeLists[index] = slot;
+    }
+
+    const MemoryStats &SlabAllocator::getStats() {
+        return stats;
+    }
+
+    FrameArena::FrameArena(): FrameArena(1 << 20) {}
+    FrameArena::FrameArena(size_t blockSize) {
+        this->blockSize = blockSize;
+        block = new char[blockSize];
+        offset = 0;
+        overflowSize = 0;
+        overflow = new std::vector<char *>();
+    }
+
+    FrameArena::~FrameArena() {
+        for(char *spill : *overflow) delete[] spill;
+        delete[] block;
+        delete overflow;
+    }
+
+    void *FrameArena::alloc(size_t size, size_t align) {
+        size_t start = (offset + align - 1) & ~(align - 1);
+        if(start + size <= blockSize) {
+            offset = start + size;
+            return block + start;
+        }
+
+        // Spill into a separate allocation; reset() grows the main block so the next frame fits.
+        char *spill = new char[size + align];
+        overflow->push_back(spill);
+        overflowSize += size + align;
+
+        size_t addr = reinterpret_cast<size_t>(spill);
+        return spill + (((addr + align - 1) & ~(align - 1)) - addr);
+    }
+
+    void FrameArena::reset() {
+        if(!overflow->empty()) {
+            for(char *spill : *overflow) delete[] spill;
+            overflow->clear();
+
+            delete[] block;
+            blockSize = (blockSize + overflowSize) * 2;
+            block = new char[blockSize];
+            overflowSize = 0;
+        }
+
+        offset = 0;
+    }
+
+    size_t FrameArena::used() { return offset + overflowSize; }
+    size_t FrameArena::capacity() { return blockSize; }
+}
@@ -0,0 +1,96 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <vector>
+
+namespace Fantasy {
+    struct MemoryStats {
+        public:
+        const char *name;
+        size_t allocations, frees;
+        size_t bytes, peak, reserved;
+
+        public:
+        MemoryStats(const char *);
+
+        void alloc(size_t);
+        void free(size_t);
+        float fragmentation() const;
+        void log() const;
+    };
+
+    class SlabAllocator {
+        private:
+        struct Slot {
+            Slot *next;
+        };
+
+        static const size_t chunkSize = 16 * 1024;
+        static const int classCount = 14;
+        static const size_t classSizes[classCount];
+
+        Slot *freeLists[classCount];
+        std::vector<char *> *chunks;
+        MemoryStats stats;
+
+        public:
+        SlabAllocator(const char *);
+        ~SlabAllocator();
+
+        void *alloc(size_t);
+        void free(void *, size_t);
+        const MemoryStats &getStats();
+
+        private:
+        int sizeClass(size_t);
+    };
+
+    class Memory {
+        public:
+        static size_t allocations();
+        static size_t allocatedBytes();
+        static SlabAllocator &box2d();
+    };
+
+    class FrameArena {
+        private:
+        char *block;
+        size_t blockSize;
+        size_t offset;
+        size_t overflowSize;
+        std::vector<char *> *overflow;
+
+        public:
+        FrameArena();
+        FrameArena(size_t);
+        ~FrameArena();
+
+        void *alloc(size_t, size_t);
+        void reset();
+        size_t used();
+        size_t capacity();
+    };
+
+    template<typename T>
+    class ArenaAllocator {
+        public:
+        typedef T value_type;
+        FrameArena *arena;
+
+        public:
+        ArenaAllocator(FrameArena &arena) noexcept: arena(&arena) {}
+        template<typename U> ArenaAllocator(const ArenaAllocator<U> &other) noexcept: arena(other.arena) {}
+
+        T *allocate(size_t count) { return static_cast<T *>(arena->alloc(count * sizeof(T), alignof(T))); }
+        void deallocate(T *, size_t) noexcept {}
+
+        template<typename U> bool operator==(const ArenaAllocator<U> &other) const noexcept { return arena == other.arena; }
+        template<typename U> bool operator!=(const ArenaAllocator<U> &other) const noexcept { return arena != other.arena; }
+    };
+
+    template<typename T>
+    using FrameVector = std::vector<T, ArenaAllocator<T>>;
+}
+
+#endif
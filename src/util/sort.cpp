@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <cstring>
+
+#include "sort.h"
+
+namespace Fantasy {
+    void Sort::radix(SortKey *keys, SortKey *scratch, size_t count) {
+        if(count < 64) {
+            std::stable_sort(keys, keys + count, [](const SortKey &a, const SortKey &b) { return a.key < b.key; });
+            return;
+        }
+
+        size_t counts[8][256];
+        std::memset(counts, 0, sizeof(counts));
+
+        for(size_t i = 0; i < count; i++) {
+            uint64_t key = keys[i].key;
+            for(int pass = 0; pass < 8; pass++) counts[pass][(key >> (pass * 8)) & 0xff]++;
+        }
+
+        SortKey *from = keys, *to = scratch;
+        for(int pass = 0; pass < 8; pass++) {
+            int shift = pass * 8;
+            size_t *offsets = counts[pass];
+
+            // Every key has the same digit here, so this pass wouldn't move anything.
+            if(offsets[(from[0].key >> shift) & 0xff] == count) continue;
+
+            size_t sum = 0;
+            for(int digit = 0; digit < 256; digit++) {
+                size_t amount = offsets[digit];
+                offsets[digit] = sum;
+                sum += amount;
+            }
+
+            for(size_t i = 0; i < count; i++) to[offsets[(from[i].key >> shift) & 0xff]++] = from[i];
+            std::swap(from, to);
+        }
+
+        if(from != keys) std::memcpy(keys, from, count * sizeof(SortKey));
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Fantasy {
+    struct SortKey {
+        public:
+        uint64_t key;
+        uint32_t value;
+    };
+
+    class Sort {
+        public:
+        // Stable LSD radix sort on the key, a byte per pass. Scratch must hold as many entries as the keys.
+        static void radix(SortKey *, SortKey *, size_t);
+
+        // Maps a float to bits that compare as unsigned integers in the same order.
+        static inline uint32_t orderedBits(float value) {
+            union { float f; uint32_t u; } bits;
+            bits.f = value;
+            return (bits.u & 0x80000000u) ? ~bits.u : bits.u | 0x80000000u;
+        }
+    };
+}
+
+#endif